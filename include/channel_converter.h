@@ -22,7 +22,8 @@ BEGIN_NAMESPACE_JET_MODULE
 class ChannelConverter : public FunctionBlockConverter 
 {
 public:
-    ChannelConverter(const InstancePtr& opendaqInstance) : FunctionBlockConverter(opendaqInstance) {}
+    ChannelConverter(const InstancePtr& opendaqInstance, const JetServerConfig& config, ComponentIndex& componentIndex, OpendaqEventQueue& opendaqEventQueue)
+        : FunctionBlockConverter(opendaqInstance, config, componentIndex, opendaqEventQueue) {}
     void composeJetState(const ComponentPtr& component) override;
 };
 
@@ -20,6 +20,9 @@
 #include <opendaq/folder_ptr.h>
 #include "property_manager.h"
 #include "property_converter.h"
+#include "jet_server_config.h"
+#include "component_index.h"
+#include "opendaq_event_queue.h"
 #include "jet_peer_wrapper.h"
 #include "opendaq_event_handler.h"
 #include "jet_event_handler.h"
@@ -35,16 +38,23 @@ BEGIN_NAMESPACE_JET_MODULE
 class ComponentConverter
 {
 public:
-    explicit ComponentConverter(const InstancePtr& opendaqInstance);
+    explicit ComponentConverter(const InstancePtr& opendaqInstance, const JetServerConfig& config, ComponentIndex& componentIndex, OpendaqEventQueue& opendaqEventQueue);
 
     virtual void composeJetState(const ComponentPtr& component);
 
-protected:
-    void createOpendaqCallback(const ComponentPtr& component);
+    // Callbacks are also needed for Jet states restored from a snapshot
     JetStateCallback createJetCallback();
     JetStateCallback createObjectPropertyJetCallback();
+    JetStateCallback createPropertyJetCallback();
+
+protected:
+    void createOpendaqCallback(const ComponentPtr& component);
+    void onComponentCoreEvent(ComponentPtr& comp, CoreEventArgsPtr& args);
+    void handleOpendaqEvent(const ComponentPtr& comp, const CoreEventArgsPtr& args);
+    void throwSetErrors(const std::string& path, const Json::Value& errors);
 
     void appendProperties(const ComponentPtr& component, Json::Value& parentJsonValue);
+    void publishPropertyJetState(const ComponentPtr& component, const PropertyPtr& property);
 
     // Append common metadata to Json value
     void appendObjectType(const ComponentPtr& component, Json::Value& parentJsonValue);
@@ -52,6 +62,9 @@ protected:
     void appendVisibleStatus(const ComponentPtr& component, Json::Value& parentJsonValue);
     void appendTags(const ComponentPtr& component, Json::Value& parentJsonValue);
 
+    const JetServerConfig& config;
+    ComponentIndex& componentIndex;
+    OpendaqEventQueue& opendaqEventQueue;
     JetPeerWrapper& jetPeerWrapper;
     PropertyManager propertyManager;
     PropertyConverter propertyConverter;
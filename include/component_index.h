@@ -0,0 +1,76 @@
+/*
+ * Copyright 2022-2023 Blueberry d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include "common.h"
+#include <opendaq/instance_ptr.h>
+#include <opendaq/component_ptr.h>
+#include "jet_event_handler.h"
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Target of a Jet state. Property name is empty for Jet states representing a whole component, otherwise it holds the name of
+ * the ObjectProperty (or the property with JetStateLayout::PerProperty) which is published as "<globalId>/<propertyName>".
+ * 
+ */
+struct ComponentIndexEntry
+{
+    ComponentPtr component;
+    std::string propertyName;
+};
+
+/**
+ * @brief Maps paths of published Jet states to the openDAQ components which own them, so that a value change requested from Jet
+ * is resolved with a single lookup instead of searching the openDAQ tree. Setters of the published properties are kept as well, so that
+ * properties don't have to be introspected on every change. It is filled while publishing and can be used from any thread.
+ * 
+ */
+class ComponentIndex
+{
+public:
+    explicit ComponentIndex(const InstancePtr& opendaqInstance);
+
+    void addComponent(const std::string& path, const ComponentPtr& component);
+    void addProperty(const std::string& path, const ComponentPtr& component, const std::string& propertyName);
+    void addSetter(const std::string& globalId, const std::string& propertyName, const JetPropertySetter& setter);
+    bool findSetter(const std::string& globalId, const std::string& propertyName, JetPropertySetter& setter);
+    bool contains(const std::string& path);
+    void removeEntry(const std::string& path);
+    bool addSubscription(const std::string& globalId, std::function<void()> unsubscribe);
+    void removeSubscriptions();
+    void removeComponent(const std::string& globalId);
+    void removeProperty(const std::string& globalId, const std::string& propertyName);
+    void clear();
+    bool resolve(const std::string& path, ComponentIndexEntry& entry);
+    size_t size();
+    std::unordered_map<std::string, ComponentIndexEntry> getEntries();
+
+private:
+    bool findInOpendaq(const std::string& path, ComponentIndexEntry& entry);
+
+    InstancePtr opendaqInstance;
+    std::unordered_map<std::string, ComponentIndexEntry> entries;
+    std::unordered_map<std::string, JetPropertySetter> setters; // Keyed by "<globalId>/<propertyName>"
+    // Components whose core events are observed, with the functions which detach the handlers. Kept by clear(), components stay subscribed
+    std::unordered_map<std::string, std::function<void()>> subscriptions;
+    std::shared_mutex mutex;
+};
+
+END_NAMESPACE_JET_MODULE
@@ -26,7 +26,8 @@ BEGIN_NAMESPACE_JET_MODULE
 class DeviceConverter : public ComponentConverter
 {
 public:
-    DeviceConverter(const InstancePtr& opendaqInstance) : ComponentConverter(opendaqInstance) {}
+    DeviceConverter(const InstancePtr& opendaqInstance, const JetServerConfig& config, ComponentIndex& componentIndex, OpendaqEventQueue& opendaqEventQueue)
+        : ComponentConverter(opendaqInstance, config, componentIndex, opendaqEventQueue) {}
     void composeJetState(const ComponentPtr& component) override;
 
 private:
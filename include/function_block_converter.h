@@ -22,7 +22,8 @@ BEGIN_NAMESPACE_JET_MODULE
 class FunctionBlockConverter : public ComponentConverter 
 {
 public:
-    FunctionBlockConverter(const InstancePtr& opendaqInstance) : ComponentConverter(opendaqInstance) {}
+    FunctionBlockConverter(const InstancePtr& opendaqInstance, const JetServerConfig& config, ComponentIndex& componentIndex, OpendaqEventQueue& opendaqEventQueue)
+        : ComponentConverter(opendaqInstance, config, componentIndex, opendaqEventQueue) {}
     void composeJetState(const ComponentPtr& component) override;
 
 protected:
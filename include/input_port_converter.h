@@ -22,7 +22,8 @@ BEGIN_NAMESPACE_JET_MODULE
 class InputPortConverter : public ComponentConverter 
 {
 public:
-    InputPortConverter(const InstancePtr& opendaqInstance) : ComponentConverter(opendaqInstance) {}
+    InputPortConverter(const InstancePtr& opendaqInstance, const JetServerConfig& config, ComponentIndex& componentIndex, OpendaqEventQueue& opendaqEventQueue)
+        : ComponentConverter(opendaqInstance, config, componentIndex, opendaqEventQueue) {}
     void composeJetState(const ComponentPtr& component) override;
 
 private:
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2022-2023 Blueberry d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <atomic>
+#include <functional>
+#include <hbk/sys/eventloop.h>
+#include <hbk/sys/notifier.h>
+#include "common.h"
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Lock-free multi-producer single-consumer queue of commands which have to be executed on an event loop thread.
+ * Producers enqueue commands from any thread without blocking. The event loop is woken up through a notifier (eventfd)
+ * registered with it and drains the queued commands in batches.
+ * 
+ */
+class JetCommandQueue
+{
+public:
+    using Command = std::function<void()>;
+
+    explicit JetCommandQueue(hbk::sys::EventLoop& eventloop, size_t maxBatchSize = 1024);
+    ~JetCommandQueue();
+    JetCommandQueue(const JetCommandQueue&) = delete;
+    JetCommandQueue& operator=(const JetCommandQueue&) = delete;
+
+    void push(Command command);
+
+private:
+    struct Node
+    {
+        Command command;
+        std::atomic<Node*> next{nullptr};
+    };
+
+    void drain();
+    void wakeUp();
+
+    std::atomic<Node*> head; // Producers append new nodes here
+    Node* tail;              // Only accessed by the consumer (event loop thread). Always points to an already consumed node
+    std::atomic<bool> wakeupPending;
+    size_t maxBatchSize;
+    hbk::sys::Notifier notifier;
+};
+
+END_NAMESPACE_JET_MODULE
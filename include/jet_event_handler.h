@@ -21,6 +21,26 @@
 
 BEGIN_NAMESPACE_JET_MODULE
 
+class JetEventHandler;
+struct JetPropertySetter;
+
+// Applies a value received from Jet to a property. Returns empty string on success, otherwise description of the error
+using JetPropertySetFunction = std::string (*)(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName,
+                                               const Json::Value& newPropertyValue, const JetPropertySetter& setter);
+
+/**
+ * @brief Setter of a single property compiled when the property is published. It holds everything the property has to be introspected for,
+ * so applying a value from Jet is a table lookup and a call of the typed set function. Read-only flag is not part of it, because it can
+ * change after publishing (e.g. it is bound to another property).
+ * 
+ */
+struct JetPropertySetter
+{
+    CoreType valueType = CoreType::ctUndefined;
+    CoreType itemType = CoreType::ctUndefined; // Type of items of lists and dicts
+    JetPropertySetFunction apply = nullptr;
+};
+
 /**
  * @brief Handler of events occured in Jet states. Functions in this class update openDAQ components based on changes in their corresponding
  * Jet states.
@@ -32,15 +52,31 @@ public:
     JetEventHandler();
 
     // Update functions addressing change events from Jet (e.g. using "jetset" tool)
-    void updateProperty(const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue);
+    std::string updateProperty(const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue);
     template <typename DataType>
     void updateSimpleProperty(const ComponentPtr& component, const std::string& propertyName, const DataType& newPropertyValue);
     void updateListProperty(const ComponentPtr& component, const std::string& propertyName, const Json::Value& newJsonArray);
     void updateDictProperty(const ComponentPtr& component, const std::string& propertyName, const Json::Value& newJsonDict);
-    void updateObjectProperty(const ComponentPtr& component, const Json::Value& newJsonObject);
-    void updateActiveStatus(const ComponentPtr& component, const Json::Value& newActiveStatus);
+    Json::Value updateObjectProperty(const ComponentPtr& component, const Json::Value& newJsonObject);
+    std::string updateActiveStatus(const ComponentPtr& component, const Json::Value& newActiveStatus);
+
+    static JetPropertySetter compileSetter(const PropertyPtr& property);
+    std::string applySetter(const JetPropertySetter& setter, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue);
+
+    static Json::Value extractChangedMembers(const Json::Value& newJsonObject, const Json::Value& currentJsonObject, bool recursive);
+    static std::string describeCurrentException();
 
 private:
+    // Typed set functions referenced by compiled setters
+    static std::string setBoolValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter& setter);
+    static std::string setIntValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter& setter);
+    static std::string setFloatValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter& setter);
+    static std::string setStringValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter& setter);
+    static std::string setListValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter& setter);
+    static std::string setDictValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter& setter);
+    static std::string rejectValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter& setter);
+    static std::string checkItemTypes(const Json::Value& items, CoreType itemType);
+
     // Helper functions
     std::vector<std::pair<std::string, Json::Value>> extractObjectPropertyPathsAndValues(const Json::Value& objectPropertyJetState);
     void extractObjectPropertyPathsAndValuesInternal(const Json::Value& objectPropertyJetState, const std::string& path, std::vector<std::pair<std::string, Json::Value>>& pathAndValuePairs);
@@ -34,7 +34,11 @@ enum JetModuleException : int
     JM_FUNCTION_UNSUPPORTED_ARGUMENT_TYPE,
     JM_FUNCTION_UNSUPPORTED_ARGUMENT_FORMAT,
     JM_FUNCTION_UNSUPPORTED_RETURN_TYPE,
-    JM_UNEXPECTED_TYPE
+    JM_UNEXPECTED_TYPE,
+    JM_SET_QUEUE_FULL,
+    JM_SET_FAILED,
+    JM_SET_TIMEOUT,
+    JM_CALL_TIMEOUT
 };
 
 bool checkTypeCompatibility(Json::ValueType jsonValueType, daq::CoreType daqValueType);
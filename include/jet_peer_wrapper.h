@@ -14,12 +14,31 @@
  * limitations under the License.
  */
 #pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <json/value.h>
 #include <opendaq/device_impl.h>
 #include <jet/peerasync.hpp>
+#include <hbk/sys/timer.h>
 #include "common.h"
+#include "jet_command_queue.h"
 #include "jet_module_exceptions.h"
+#include "jet_set_executor.h"
+
+#define JET_STATE_READ_TIMEOUT (5) // 5 seconds
+#define JET_STATE_SET_TIMEOUT (5) // 5 seconds
+#define JET_METHOD_CALL_TIMEOUT (5000) // 5000 milliseconds, until JetServer sets its own
+#define JET_DELTA_STATE_SUFFIX "/_delta" // Suffix of the companion Jet state carrying changes of a Jet state in delta mode
 
 using namespace daq;
 
@@ -30,6 +49,92 @@ using JetStateCallback  = std::function<Json::Value(const Json::Value&, const st
 // Callback which is called when a Jet method is called
 using JetMethodCallback = std::function<Json::Value(const Json::Value&)>;
 
+// Acknowledgement counters and round-trip latencies of Jet state and method publications
+struct JetPublicationStatistics
+{
+    size_t acknowledged = 0; // Publications accepted by jetd
+    size_t failed = 0;       // Publications rejected by jetd (e.g. path already exists)
+    size_t pending = 0;      // Publications which have not been acknowledged yet
+    std::chrono::microseconds totalLatency{0}; // Sum of round-trip latencies of all acknowledged and failed publications
+    std::chrono::microseconds maxLatency{0};
+};
+
+// Change of a Jet state which is waiting to be notified
+struct JetStateChange
+{
+    Json::Value jetState;
+    std::set<std::string> changedKeys; // Changed top-level members
+    std::set<std::string> removedKeys; // Removed top-level members
+
+    void merge(JetStateChange change);
+};
+
+/**
+ * @brief Marks the current thread as applying a value change requested from Jet. openDAQ reports the change back through its core events,
+ * which update the local copies of Jet states. While the scope is alive those updates are only collected, and a single notification per
+ * Jet state is sent when the scope ends, instead of one notification per echoed property. Scopes can be nested. The scope is also used
+ * to notify a batch of openDAQ property changes (beginUpdate/endUpdate) at once.
+ * 
+ */
+class JetWriteScope
+{
+public:
+    JetWriteScope();
+    ~JetWriteScope();
+    JetWriteScope(const JetWriteScope&) = delete;
+    JetWriteScope& operator=(const JetWriteScope&) = delete;
+
+    static bool isActive();
+
+private:
+    friend class JetPeerWrapper;
+
+    static thread_local JetWriteScope* current;
+    JetWriteScope* outer;
+    std::map<std::string, JetStateChange> changes;
+};
+
+/**
+ * @brief Holds back Jet state and method publications issued by the current thread while the capture is active. They are handed to the
+ * Jet event loop together by release(), so publications composed on several threads can be sent in a deterministic order.
+ * A capture is activated by its constructor on the thread which creates it and deactivated by end() on the same thread.
+ * Publications which have not been released are released by the destructor.
+ * 
+ */
+class JetPublicationCapture
+{
+public:
+    JetPublicationCapture();
+    explicit JetPublicationCapture(JetPublicationCapture* parent);
+    ~JetPublicationCapture();
+    JetPublicationCapture(const JetPublicationCapture&) = delete;
+    JetPublicationCapture& operator=(const JetPublicationCapture&) = delete;
+
+    void end();
+    void release();
+    void discard(const std::set<std::string>& discardedPaths);
+    size_t size() const;
+    const std::vector<std::string>& getPaths() const;
+    static JetPublicationCapture* getActive();
+
+private:
+    friend class JetPeerWrapper;
+
+    struct CapturedPublication
+    {
+        std::string path;
+        size_t count; // Number of Jet states and methods registered as pending by the publication
+        std::function<void()> command;
+    };
+
+    static thread_local JetPublicationCapture* current;
+    JetPublicationCapture* previous; // Capture which was active on the thread before this one
+    JetPublicationCapture* parent;   // Capture to which publications are released. Null releases them to the Jet event loop
+    bool active;
+    std::vector<CapturedPublication> publications;
+    std::vector<std::string> paths; // Paths of all captured publications, also after they have been released
+};
+
 //! This class has to be instantiated only once because PeerAsync occupies unix socket
 //! Singleton pattern is utilized
 /**
@@ -40,6 +145,9 @@ using JetMethodCallback = std::function<Json::Value(const Json::Value&)>;
  */
 class JetPeerWrapper
 {
+    friend class JetWriteScope;
+    friend class JetPublicationCapture;
+
 public:
     // Accessor for the JetPeerWrapper instance
     static JetPeerWrapper& getInstance() {
@@ -47,13 +155,30 @@ public:
         return instance;
     }
 
-    void publishJetState(const std::string& path, const Json::Value& jetState, JetStateCallback callback);
+    void publishJetState(const std::string& path, const Json::Value& jetState, JetStateCallback callback, const std::string& setLane = std::string());
     void publishJetMethod(const std::string& path, JetMethodCallback callback);
     void removeJetMethod(const std::string& path);
+    void removeJetStates(const std::string& path, bool recursive = true);
+    void refreshJetState(const std::string& path);
     Json::Value readJetState(const std::string& path);
     Json::Value readAllJetStates();
     void updateJetState(const std::string& path, const Json::Value newValue);
+    void updateJetStateValue(const std::string& path, const std::vector<std::string>& valuePath, const Json::Value& newValue);
+    Json::Value getCachedJetState(const std::string& path);
+    void setNotificationCoalescing(std::chrono::milliseconds window, size_t maxPending);
+    void setDeltaNotifications(bool enabled, size_t baselineThreshold);
+    void setMaxPublicationsInFlight(size_t maxInFlight);
+    void configureSetExecutor(size_t threadCount, size_t priorityThreadCount, size_t queueCapacity, JetSetOverflowPolicy overflowPolicy);
+    JetSetExecutorStatistics getSetExecutorStatistics();
+    void setSynchronousSets(std::chrono::milliseconds timeout);
+    void setMethodCallTimeout(std::chrono::milliseconds timeout);
+    JetPublicationStatistics getPublicationStatistics();
+    bool waitForPublications(std::chrono::milliseconds timeout);
+    bool waitForQueuedCommands(std::chrono::milliseconds timeout);
+    void waitForSetTasks();
     void modifyJetState(const char* valueType, const std::string& path, const char* newValue);
+    std::future<Json::Value> setJetState(const std::string& path, const Json::Value& value);
+    std::future<Json::Value> setJetStates(const std::vector<std::pair<std::string, Json::Value>>& values);
 
     // Helper functions
     std::string removeRootDeviceId(const std::string& path);
@@ -65,16 +190,102 @@ private:
     JetPeerWrapper(const JetPeerWrapper&) = delete; // Prevent copy-construction
     JetPeerWrapper& operator=(const JetPeerWrapper&) = delete; // Prevent assignment
 
-    static void readJetStateCb(std::promise<Json::Value>& promise, const Json::Value& value);
+    // Top-level members changed since the last full notification of a Jet state published in delta mode
+    struct JetStateDelta
+    {
+        Json::Value changed = Json::Value(Json::objectValue);
+        std::set<std::string> removed;
+        uint64_t version = 0;
+    };
+
+    // Jet state or method waiting in the publication queue
+    struct JetPublication
+    {
+        std::string path;
+        JetStateCallback stateCallback;   // Assigned for Jet states
+        JetMethodCallback methodCallback; // Assigned for Jet methods
+        bool withDelta = false;           // Whether the companion delta Jet state has to be published as well
+    };
+
+    Json::Value readJetStates(const hbk::jet::matcher_t& match);
+    JetStateCallback dispatchToSetExecutor(JetStateCallback callback, const std::string& lane);
+    JetMethodCallback dispatchMethodToSetExecutor(JetMethodCallback callback, const std::string& lane);
+    bool changesActiveStatus(const std::string& path, const Json::Value& value);
+    void pushPublication(const JetPublication& publication);
+    void queuePublication(const JetPublication& publication);
+    void sendQueuedPublications();
+    void queueJetStateNotification(const std::string& path, JetStateChange change);
+    void flushWriteScope(std::map<std::string, JetStateChange>& changes);
+    void notifyJetState(const std::string& path, JetStateChange change);
+    void sendJetStateNotification(const std::string& path, const JetStateChange& change);
+    void flushJetStateNotifications();
+    static void replaceCachedJetState(Json::Value& cachedJetState, const Json::Value& newValue, JetStateChange& change);
+    void beginPublications(size_t count);
+    void cancelPublications(size_t count);
+    hbk::jet::responseCallback_t trackPublication(const std::string& path);
+    static Json::Value composeDeltaDocument(const JetStateDelta& delta);
+    static bool isInSubtree(const std::string& path, const std::string& rootPath);
+    static std::string describeException(std::exception_ptr exception);
 
     hbk::jet::PeerAsync* jetPeer;
 
+    // Local copy of every Jet state published by this peer, keyed by Jet state path.
+    // It is the authoritative source for updates, so jetd does not have to be queried on every change.
+    std::unordered_map<std::string, Json::Value> jetStateCache;
+    std::mutex jetStateCacheMutex;
+    bool deltaNotificationsEnabled; // Guarded by jetStateCacheMutex
+
     void startJetEventloop();
     void stopJetEventloop();
     void startJetEventloopThread();
     hbk::sys::EventLoop jetEventloop;
     bool jetEventloopRunning;
     std::thread jetEventloopThread;
+    // PeerAsync is not thread safe, so every call to jetPeer is queued here and executed on the event loop thread
+    JetCommandQueue jetCommandQueue;
+
+    // Acknowledgement tracking of publications
+    JetPublicationStatistics publicationStatistics;
+    std::mutex publicationStatisticsMutex;
+    std::condition_variable publicationsAcknowledged;
+
+    // Coalescing of notifications. Only accessed from the event loop thread.
+    // Latest value of each Jet state changed within the coalescing window is kept until the window expires.
+    std::chrono::milliseconds coalescingWindow;
+    size_t coalescingMaxPending;
+    std::unordered_map<std::string, JetStateChange> pendingNotifications;
+    std::vector<std::string> pendingNotificationOrder; // Paths in order of their first change within the window
+    hbk::sys::Timer coalescingTimer;
+
+    // Delta notifications. Only accessed from the event loop thread.
+    // Instead of the whole Jet state, only a document with the members changed since the last full notification is notified
+    // to the companion Jet state "<path>/_delta". Full Jet state is notified again once the document grows above the threshold.
+    std::unordered_map<std::string, JetStateDelta> jetStateDeltas;
+    size_t deltaBaselineThreshold;
+
+    // Publication pipeline. Only accessed from the event loop thread.
+    // At most maxPublicationsInFlight publications are sent without being acknowledged, the rest waits in the queue.
+    std::deque<JetPublication> publicationQueue;
+    std::unordered_map<std::string, size_t> unsentPublicationPaths; // Number of queued publications per path
+    size_t maxPublicationsInFlight;
+    size_t publicationsInFlight;
+    std::set<std::string> publishedMethodPaths; // Jet methods sent to jetd, needed to remove them together with their component
+
+    // Applies value changes requested from Jet, so that the Jet event loop only queues them
+    JetSetExecutor setExecutor;
+    std::chrono::milliseconds synchronousSetTimeout; // Only accessed from the event loop thread. Zero answers set requests immediately
+    std::chrono::milliseconds methodCallTimeout;     // Only accessed from the event loop thread
+
+    // Long-lived TCP peer used for reading Jet states from jetd. It is driven by its own event loop so that reads
+    // can be issued while the main event loop is busy. Requests are queued to the loop thread and correlated with
+    // their responses by PeerAsync, so multiple reads can be in flight at once.
+    void startJetClientEventloop();
+    void stopJetClientEventloop();
+    hbk::jet::PeerAsync* jetClientPeer;
+    hbk::sys::EventLoop jetClientEventloop;
+    bool jetClientEventloopRunning;
+    std::thread jetClientEventloopThread;
+    JetCommandQueue jetClientCommandQueue;
 };
 
 END_NAMESPACE_JET_MODULE
\ No newline at end of file
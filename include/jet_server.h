@@ -14,9 +14,19 @@
  * limitations under the License.
  */
 #pragma once
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
 #include <thread>
+#include <vector>
 #include "common.h"
 #include <opendaq/instance_ptr.h>
+#include "jet_server_config.h"
+#include "component_index.h"
+#include "publish_filter.h"
+#include "jet_snapshot.h"
 #include "component_converter.h"
 #include "device_converter.h"
 #include "function_block_converter.h"
@@ -24,22 +34,55 @@
 #include "signal_converter.h"
 #include "input_port_converter.h"
 
+#define JET_INDEX_STATE_SUFFIX "/_index"   // Suffix of the Jet state listing components of a device in lazy publication mode
+#define JET_EXPAND_METHOD_SUFFIX "/_expand" // Suffix of the Jet method (under the root device) which composes a Jet state on demand
+
 BEGIN_NAMESPACE_JET_MODULE
 
 class JetServer
 {
 public:
-    explicit JetServer(const InstancePtr& instance);
+    explicit JetServer(const InstancePtr& instance, const JetServerConfig& config = JetServerConfig());
     ~JetServer();
     void publishJetStates();
+    bool waitForOpendaqEvents(std::chrono::milliseconds timeout);
 
 protected:
 
 private:
     void parseOpendaqInstance(const FolderPtr& parentFolder);
+    void collectComponents(const FolderPtr& parentFolder, std::vector<ComponentPtr>& components);
+    void composeJetStates(const std::vector<ComponentPtr>& components);
+    void composeJetState(const ComponentPtr& component);
+    void onCoreEvent(ComponentPtr& sender, CoreEventArgsPtr& args);
+    void publishSubtree(const ComponentPtr& component);
+    void unpublishSubtree(const std::string& globalId);
+    static bool hasOwnJetState(const ComponentPtr& component);
+
+    // Lazy publication mode (JetServerConfig::lazyPublication)
+    void publishIndexStates();
+    void publishExpandMethod();
+    Json::Value expandJetState(const std::string& path);
+    void evictIdleJetStates();
+    void runEviction();
+
+    // Warm start from a snapshot (JetServerConfig::snapshotFile)
+    bool publishSnapshot();
+    void reconcileSnapshot();
+    void writeSnapshot();
 
+    // Jet states and methods published by expanding a component
+    struct LazyExpansion
+    {
+        std::vector<std::string> paths;
+        std::chrono::steady_clock::time_point lastAccess;
+    };
+
+    JetServerConfig config;
     InstancePtr opendaqInstance;
     DevicePtr rootDevice; // Pointer to the root openDAQ device whose tree structure is parsed in order to publish it as Jet states
+    ComponentIndex componentIndex; // Resolves Jet state paths to components, shared by all converters
+    OpendaqEventQueue opendaqEventQueue; // Core events of published components are handled on its publisher thread
 
     ComponentConverter componentConverter;
     DeviceConverter deviceConverter;
@@ -47,6 +90,21 @@ private:
     ChannelConverter channelConverter;
     SignalConverter signalConverter;
     InputPortConverter inputPortConverter;
+    PublishFilter publishFilter; // Selects the components whose Jet states are published
+
+    std::map<std::string, LazyExpansion> expandedComponents; // Keyed by global ID of the expanded component
+    std::set<std::string> indexStatePaths;
+    std::mutex expansionMutex;
+    std::thread evictionThread;
+    std::condition_variable evictionCondition;
+    bool evictionRunning;
+
+    std::vector<JetSnapshotEntry> snapshotEntries; // Jet states published from the snapshot, until they are reconciled
+    // Versions of the Jet states stored in the snapshot file, so that only the changed ones are appended to it
+    std::map<std::string, uint64_t> snapshotFileVersions;
+    size_t snapshotFileRecords; // Including outdated records, the file is compacted once there are too many of them
+    bool snapshotFileValid; // Whether the file holds snapshotFileVersions and can be appended to
+    std::thread reconcileThread;
 };
 
 
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2022-2023 Blueberry d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+#include "common.h"
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Defines how properties of a component are laid out in Jet states.
+ * 
+ */
+enum class JetStateLayout
+{
+    // One Jet state per component holding all of its properties. ObjectProperties are published as separate Jet states.
+    Component = 0,
+    // Every property is published as its own Jet state "<globalId>/<propertyName>". Component Jet state only holds metadata.
+    PerProperty
+};
+
+/**
+ * @brief Defines what happens to a value change requested from Jet when the queue of the set executor is full.
+ * 
+ */
+enum class JetSetOverflowPolicy
+{
+    // Request is dropped and Jet client receives an error
+    Reject = 0,
+    // Jet event loop waits until there is room in the queue, which throttles the clients
+    Block
+};
+
+/**
+ * @brief Types of openDAQ components distinguished by JetPublishFilter.
+ * 
+ */
+enum class JetComponentType
+{
+    Device = 0,
+    FunctionBlock,
+    Channel,
+    Signal,
+    InputPort,
+    Component // Any other component which has a Jet state of its own
+};
+
+/**
+ * @brief Selects the components of the openDAQ tree which are published. Exclusion rules prune the whole subtree of a matching
+ * component or folder before any of its properties is read. Inclusion rules only decide whether the component's own Jet state is
+ * published, its descendants are still visited. Empty rules match nothing (exclusion) or everything (inclusion).
+ * Root device is always published.
+ * 
+ */
+struct JetPublishFilter
+{
+    std::set<JetComponentType> includeTypes;
+    std::set<JetComponentType> excludeTypes;
+    // Global ID globs. "*" matches any characters except "/", "**" matches any characters, "?" matches a single character except "/"
+    std::vector<std::string> includePaths;
+    std::vector<std::string> excludePaths;
+    std::vector<std::string> includeTags; // Component has to carry at least one of these tags
+    std::vector<std::string> excludeTags;
+    bool excludeInvisible = false; // Prunes components whose Visible attribute is false
+};
+
+/**
+ * @brief Options which define how JetServer publishes an openDAQ instance as Jet states.
+ * Default values publish the same Jet states as a JetServer constructed without configuration. The work is scheduled differently though:
+ * Jet states are composed by several threads, openDAQ events are handled by a publisher thread and JetServer::publishJetStates waits for
+ * jetd to acknowledge the publications. Set compositionThreads to 1, asyncOpendaqEvents to false and publicationTimeout to zero to do
+ * all of it on the calling thread without waiting.
+ * 
+ */
+struct JetServerConfig
+{
+    JetStateLayout stateLayout = JetStateLayout::Component;
+    JetPublishFilter publishFilter;
+
+    // Number of threads which compose Jet states of the components in JetServer::publishJetStates. Jet states are published
+    // in the same order regardless of the number of threads.
+    size_t compositionThreads = 4;
+    // Only a lightweight Jet state "<deviceGlobalId>/_index" listing the components of each device and the Jet method
+    // "<rootDeviceGlobalId>/_expand" are published. Jet state of a component is composed when a client calls "_expand" with its path.
+    bool lazyPublication = false;
+    // Jet states composed by "_expand" are removed again once they haven't been expanded for this long. Zero keeps them.
+    std::chrono::milliseconds lazyEvictionTimeout = std::chrono::milliseconds(60000);
+
+    // Composed Jet states are stored in this file. If it exists when JetServer::publishJetStates is called, Jet states are published
+    // from it immediately and reconciled with the openDAQ tree in the background. Empty disables snapshots.
+    std::string snapshotFile;
+
+    // JetServer::publishJetStates waits this long for jetd to acknowledge all publications. Zero disables waiting.
+    std::chrono::milliseconds publicationTimeout = std::chrono::milliseconds(10000);
+    // Maximum number of publications sent to jetd without being acknowledged. The rest waits in a queue. Zero means unlimited.
+    size_t maxPublicationsInFlight = 64;
+
+    // Notifications of the same Jet state requested within this time window are merged into a single notification
+    // carrying the latest value. Zero disables coalescing, every change is notified immediately.
+    std::chrono::milliseconds notificationCoalescingWindow = std::chrono::milliseconds(0);
+    // Pending notifications are flushed before the window expires once this many distinct Jet states are waiting
+    size_t notificationCoalescingMaxPending = 256;
+
+    // Every object Jet state gets a companion "<path>/_delta" Jet state which holds only the members changed since the Jet state
+    // itself was last notified. Subscribers merge the two, while updates send a small delta instead of the whole component.
+    // Jet states which are not objects (e.g. single properties) are always notified whole.
+    bool deltaNotifications = false;
+    // Number of changed members in a delta document after which the whole Jet state is notified again
+    size_t deltaBaselineThreshold = 32;
+
+    // Core events raised by openDAQ components are handled by a dedicated publisher thread. The thread which changed openDAQ
+    // only queues the event, Jet states are read and notified later. If false, the event is handled on the thread which raised it.
+    bool asyncOpendaqEvents = true;
+
+    // Value changes requested from Jet are applied to openDAQ by a fixed pool of worker threads
+    size_t setWorkerThreads = 4;
+    // Additional workers which only execute Jet method calls and "Active" status changes, so these never wait behind bulk property writes
+    size_t priorityWorkerThreads = 1;
+    // Maximum number of requests waiting for a worker. Zero means unlimited.
+    size_t setQueueCapacity = 1024;
+    JetSetOverflowPolicy setOverflowPolicy = JetSetOverflowPolicy::Reject;
+    // Set requests are answered once the values have been applied, with an empty result or errors of the values which failed.
+    // Jet event loop waits at most this long, so it has to be shorter than the timeout of the clients. Zero answers requests immediately.
+    std::chrono::milliseconds synchronousSetTimeout = std::chrono::milliseconds(0);
+    // Jet event loop waits this long for a Jet method executed by a priority worker before the caller receives an error
+    std::chrono::milliseconds methodCallTimeout = std::chrono::milliseconds(5000);
+};
+
+END_NAMESPACE_JET_MODULE
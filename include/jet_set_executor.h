@@ -0,0 +1,141 @@
+/*
+ * Copyright 2022-2023 Blueberry d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+#include "jet_server_config.h"
+
+// Limits of the executor until it is configured, e.g. by JetServer
+#define JET_SET_EXECUTOR_DEFAULT_THREADS (4)
+#define JET_SET_EXECUTOR_DEFAULT_PRIORITY_THREADS (1)
+#define JET_SET_EXECUTOR_DEFAULT_QUEUE_CAPACITY (1024)
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Priority of a task executed by the JetSetExecutor.
+ * 
+ */
+enum class JetSetPriority
+{
+    // Jet method calls and "Active" status changes. Served first, never rejected and never blocked by a full queue
+    High = 0,
+    // Bulk property writes
+    Low
+};
+
+/**
+ * @brief Scheduling delay (time between submission and start of execution) of the tasks of one priority.
+ * 
+ */
+struct JetSetPriorityStatistics
+{
+    uint64_t executed = 0;
+    std::chrono::microseconds totalDelay = std::chrono::microseconds(0);
+    std::chrono::microseconds maxDelay = std::chrono::microseconds(0);
+};
+
+/**
+ * @brief Counters describing the load of the JetSetExecutor. Latency is measured from submission until the task has finished.
+ * 
+ */
+struct JetSetExecutorStatistics
+{
+    size_t threads = 0;
+    size_t priorityThreads = 0; // Threads which only execute high-priority tasks
+    size_t queueCapacity = 0;
+    size_t queued = 0;      // Tasks currently waiting for a worker
+    size_t lanes = 0;       // Lanes which currently have tasks waiting or running
+    size_t peakQueued = 0;  // Highest number of waiting tasks since the executor was configured
+    uint64_t executed = 0;
+    uint64_t rejected = 0;
+    std::chrono::microseconds totalLatency = std::chrono::microseconds(0);
+    std::chrono::microseconds maxLatency = std::chrono::microseconds(0);
+    JetSetPriorityStatistics highPriority;
+    JetSetPriorityStatistics lowPriority;
+};
+
+/**
+ * @brief Fixed-size pool of worker threads which applies value changes requested from Jet to openDAQ.
+ * Every task belongs to a lane identified by a key (e.g. global ID of a component). Tasks of one lane are executed one at a time in
+ * submission order, while different lanes are spread over all workers. Lanes holding a high-priority task are served before the others,
+ * and some workers can be reserved for them. Low-priority tasks wait in a bounded queue. When the queue is full the task
+ * is rejected or the submitter waits, depending on JetSetOverflowPolicy.
+ * 
+ */
+class JetSetExecutor
+{
+public:
+    using Task = std::function<void()>;
+
+    JetSetExecutor();
+    ~JetSetExecutor();
+    JetSetExecutor(const JetSetExecutor&) = delete;
+    JetSetExecutor& operator=(const JetSetExecutor&) = delete;
+
+    void configure(size_t threadCount, size_t priorityThreadCount, size_t queueCapacity, JetSetOverflowPolicy overflowPolicy);
+    bool submit(const std::string& lane, Task task, JetSetPriority priority = JetSetPriority::Low);
+    JetSetExecutorStatistics getStatistics();
+    void waitUntilIdle();
+
+private:
+    struct QueuedTask
+    {
+        Task task;
+        JetSetPriority priority;
+        std::chrono::steady_clock::time_point submitTime;
+    };
+
+    struct Lane
+    {
+        std::deque<QueuedTask> tasks;
+        size_t highPriorityTasks = 0;
+        bool scheduled = false; // Lane is in one of the ready queues or one of its tasks is running
+        bool running = false;
+    };
+
+    void start(size_t threadCount, size_t priorityThreadCount);
+    void stop();
+    void runWorker(bool priorityOnly);
+    void scheduleLane(const std::string& key, Lane& lane);
+    bool hasReadyLane(bool priorityOnly);
+
+    std::vector<std::thread> workers;
+    std::unordered_map<std::string, Lane> lanes;
+    std::deque<std::string> readyHighPriorityLanes; // Lanes whose next task can be picked up by a worker, served first
+    std::deque<std::string> readyLanes;
+    size_t queued;
+    size_t queuedLowPriority;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable slotAvailable;
+    std::condition_variable idle; // Notified when the last lane has finished
+    bool running;
+    size_t queueCapacity;
+    JetSetOverflowPolicy overflowPolicy;
+    JetSetExecutorStatistics statistics;
+};
+
+END_NAMESPACE_JET_MODULE
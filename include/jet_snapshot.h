@@ -0,0 +1,75 @@
+/*
+ * Copyright 2022-2023 Blueberry d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <json/value.h>
+#include "common.h"
+
+#define JET_SNAPSHOT_COMPACTION_RATIO (2) // Snapshot is compacted once it holds this many records per current Jet state
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Defines which Jet callback a Jet state restored from a snapshot gets.
+ * 
+ */
+enum class JetSnapshotStateKind
+{
+    Component = 0,  // Jet state of a component
+    ObjectProperty, // Jet state "<globalId>/<propertyName>" of an ObjectProperty
+    Property        // Jet state "<globalId>/<propertyName>" of a property published with JetStateLayout::PerProperty
+};
+
+/**
+ * @brief Composed Jet state stored in a snapshot.
+ * 
+ */
+struct JetSnapshotEntry
+{
+    std::string path;
+    JetSnapshotStateKind kind = JetSnapshotStateKind::Component;
+    std::string lane;     // Set executor lane of the Jet state
+    uint64_t version = 0; // Hash of the serialized value, compared with the recomposed Jet state to detect changes
+    Json::Value value;
+};
+
+/**
+ * @brief Reads and writes snapshot files of composed Jet states, which allow JetServer to publish the tree right after a restart
+ * without reading every property through openDAQ. The file holds one compact Json document per line: a header identifying the root device
+ * followed by records of Jet states. Changes are appended as new records, a later record of a path replaces the earlier ones and a record
+ * with the "Removed" flag drops the path. Once most records are outdated the file is compacted by writing it anew to a temporary file
+ * which is renamed, so a crash never leaves a partial snapshot behind. A record torn by a crash while appending is ignored.
+ * 
+ */
+class JetSnapshot
+{
+public:
+    static bool load(const std::string& fileName, const std::string& rootDeviceId, std::vector<JetSnapshotEntry>& entries);
+    static bool load(const std::string& fileName, const std::string& rootDeviceId, std::vector<JetSnapshotEntry>& entries, size_t& records);
+    static bool write(const std::string& fileName, const std::string& rootDeviceId, const std::vector<JetSnapshotEntry>& entries);
+    static bool append(const std::string& fileName, const std::vector<JetSnapshotEntry>& entries, const std::vector<std::string>& removedPaths);
+    static uint64_t computeVersion(const Json::Value& value);
+
+private:
+    static std::string serialize(const Json::Value& value);
+    static std::string serializeEntry(const JetSnapshotEntry& entry);
+    static const char* kindToString(JetSnapshotStateKind kind);
+    static bool kindFromString(const std::string& str, JetSnapshotStateKind& kind);
+};
+
+END_NAMESPACE_JET_MODULE
@@ -16,6 +16,7 @@
 #pragma once
 #include "common.h"
 #include <opendaq/component_ptr.h>
+#include "jet_server_config.h"
 #include "jet_peer_wrapper.h"
 #include "property_manager.h"
 #include "property_converter.h"
@@ -29,11 +30,12 @@ BEGIN_NAMESPACE_JET_MODULE
 class OpendaqEventHandler
 {
 public:
-    OpendaqEventHandler();
+    explicit OpendaqEventHandler(const JetServerConfig& config);
 
     //  Update functions addressing change events from openDAQ
     //! These functions are also called when change is requested from Jet. This happens in order to update appropriate Jet state as well
     void updateProperty(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters);
+    void updateProperties(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters);
     template <typename DataType>
     void updateSimpleProperty(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters);
     void updateListProperty(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters);
@@ -42,14 +44,15 @@ public:
     void updateActiveStatus(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters);
 
     void addProperty(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters);
+    void removeProperty(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters);
 
 private:
     // Helper functions
     std::string extractPropertyName(const std::string& str);
     std::vector<std::string> extractNestedPropertyNames(const std::string& objectPropertyPath);
-    template <typename PropertyType>
-    void setNestedPropertyValue(Json::Value& jetState, const std::vector<std::string>& nestedPropertyNames, const std::string& propertyName, const PropertyType& propertyValue);
+    void updateJetStateValue(const ComponentPtr& component, const std::string& propertyPath, const std::string& propertyName, const Json::Value& newValue);
 
+    const JetServerConfig& config;
     JetPeerWrapper& jetPeerWrapper;
     PropertyManager propertyManager;
     PropertyConverter propertyConverter;
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2022-2023 Blueberry d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "common.h"
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Counters describing the load of the OpendaqEventQueue.
+ * 
+ */
+struct OpendaqEventQueueStatistics
+{
+    size_t queued = 0;      // Events currently waiting for the publisher thread
+    size_t peakQueued = 0;  // Highest number of waiting events since the queue was started
+    uint64_t processed = 0;
+    uint64_t processedInline = 0; // Events handled on the thread which raised them, see OpendaqEventQueue::dispatch
+};
+
+/**
+ * @brief Queue of openDAQ core events which are turned into Jet state updates by a dedicated publisher thread.
+ * The thread which changed openDAQ (e.g. acquisition or configuration thread of a device) only enqueues the event and returns,
+ * reading and notifying Jet states happens on the publisher thread. Events are processed in the order in which they were raised.
+ * 
+ */
+class OpendaqEventQueue
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit OpendaqEventQueue(bool asynchronous = true);
+    ~OpendaqEventQueue();
+    OpendaqEventQueue(const OpendaqEventQueue&) = delete;
+    OpendaqEventQueue& operator=(const OpendaqEventQueue&) = delete;
+
+    void dispatch(Task task);
+    bool waitUntilIdle(std::chrono::milliseconds timeout);
+    void waitForQueuedEvents();
+    void stop();
+    OpendaqEventQueueStatistics getStatistics();
+
+private:
+    void runPublisher();
+    void execute(const Task& task);
+
+    std::deque<Task> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable idle;
+    std::condition_variable taskProcessed;
+    uint64_t enqueued; // Number of events queued since the queue was started
+    bool asynchronous;
+    bool running;
+    bool busy; // Publisher thread is executing a task
+    OpendaqEventQueueStatistics statistics;
+    std::thread publisherThread;
+};
+
+END_NAMESPACE_JET_MODULE
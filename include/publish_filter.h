@@ -0,0 +1,48 @@
+/*
+ * Copyright 2022-2023 Blueberry d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include "common.h"
+#include <opendaq/component_ptr.h>
+#include "jet_server_config.h"
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Applies a JetPublishFilter to openDAQ components while the tree is traversed.
+ * 
+ */
+class PublishFilter
+{
+public:
+    explicit PublishFilter(const JetPublishFilter& filter);
+
+    bool prunes(const ComponentPtr& component) const;
+    bool prunesAncestorOf(const ComponentPtr& component) const;
+    bool includes(const ComponentPtr& component) const;
+
+    static JetComponentType getComponentType(const ComponentPtr& component);
+    static bool matchGlob(const std::string& pattern, const std::string& path);
+
+private:
+    bool hasAnyTag(const ComponentPtr& component, const std::vector<std::string>& tags) const;
+    bool matchesAnyGlob(const std::string& path, const std::vector<std::string>& patterns) const;
+
+    const JetPublishFilter& filter;
+};
+
+END_NAMESPACE_JET_MODULE
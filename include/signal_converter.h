@@ -22,7 +22,8 @@ BEGIN_NAMESPACE_JET_MODULE
 class SignalConverter : public ComponentConverter 
 {
 public:
-    SignalConverter(const InstancePtr& opendaqInstance) : ComponentConverter(opendaqInstance) {}
+    SignalConverter(const InstancePtr& opendaqInstance, const JetServerConfig& config, ComponentIndex& componentIndex, OpendaqEventQueue& opendaqEventQueue)
+        : ComponentConverter(opendaqInstance, config, componentIndex, opendaqEventQueue) {}
     void composeJetState(const ComponentPtr& component) override;
 
 private:
@@ -1,9 +1,15 @@
 #include "component_converter.h"
+#include <jet/defines.h>
 #include "jet_module_exceptions.h"
 #include <opendaq/logger_component_factory.h>
 BEGIN_NAMESPACE_JET_MODULE
 
-ComponentConverter::ComponentConverter(const InstancePtr& opendaqInstance) : jetPeerWrapper(JetPeerWrapper::getInstance())
+ComponentConverter::ComponentConverter(const InstancePtr& opendaqInstance, const JetServerConfig& config, ComponentIndex& componentIndex, OpendaqEventQueue& opendaqEventQueue)
+    : config(config)
+    , componentIndex(componentIndex)
+    , opendaqEventQueue(opendaqEventQueue)
+    , jetPeerWrapper(JetPeerWrapper::getInstance())
+    , opendaqEventHandler(config)
 {
     this->opendaqInstance = opendaqInstance;
 }
@@ -33,6 +39,7 @@ void ComponentConverter::composeJetState(const ComponentPtr& component)
 
     // Publish the component's tree structure as a Jet state
     std::string path = component.getGlobalId();
+    componentIndex.addComponent(path, component);
     jetPeerWrapper.publishJetState(path, jetState, jetStateCallback);
 }
 
@@ -44,32 +51,89 @@ void ComponentConverter::composeJetState(const ComponentPtr& component)
  */
 void ComponentConverter::createOpendaqCallback(const ComponentPtr& component)
 {
-    component.getOnComponentCoreEvent() += [this](const ComponentPtr& comp, const CoreEventArgsPtr& args)
-    {
-        std::string message = "Unknown change occured to component \"" + comp.getName() + "\"\n";
+    // Handler refers to this converter, so it is detached through the index before JetServer destroys the converters
+    auto unsubscribe = [this, component]() {
+        component.getOnComponentCoreEvent() -= event(this, &ComponentConverter::onComponentCoreEvent);
+    };
 
-        DictPtr<IString, IBaseObject> eventParameters = args.getParameters();
-        
-        CoreEventId eventId = CoreEventId(args.getEventId());
-        switch(eventId) {
-            case CoreEventId::PropertyValueChanged:
-                opendaqEventHandler.updateProperty(comp, eventParameters);
-                break;
-            case CoreEventId::AttributeChanged:
-                if(eventParameters.hasKey("Active")) // Active status changed
-                    opendaqEventHandler.updateActiveStatus(comp, eventParameters);
-                else
-                    DAQLOG_W(jetModuleLogger, message.c_str());
-                break;
-            case CoreEventId::PropertyAdded:
-                opendaqEventHandler.addProperty(comp, eventParameters);
-                break;
-            default:
+    // Component which is published again (e.g. expanded after eviction) keeps its existing subscription
+    if(!componentIndex.addSubscription(component.getGlobalId(), unsubscribe))
+        return;
+
+    component.getOnComponentCoreEvent() += event(this, &ComponentConverter::onComponentCoreEvent);
+}
+
+/**
+ * @brief Handler of the core events raised by a published component. Called on the thread which changed openDAQ.
+ * 
+ * @param comp Component which raised the event.
+ * @param args Arguments of the core event.
+ */
+void ComponentConverter::onComponentCoreEvent(ComponentPtr& comp, CoreEventArgsPtr& args)
+{
+    // Only references are captured here, Jet states are read and notified on the publisher thread
+    opendaqEventQueue.dispatch([this, comp, args]() { handleOpendaqEvent(comp, args); });
+}
+
+/**
+ * @brief Updates Jet states according to a core event raised by an openDAQ component. Called by the publisher thread of the OpendaqEventQueue.
+ * 
+ * @param comp Component which raised the event.
+ * @param args Arguments of the core event.
+ */
+void ComponentConverter::handleOpendaqEvent(const ComponentPtr& comp, const CoreEventArgsPtr& args)
+{
+    // Jet state of the component has been evicted (JetServerConfig::lazyPublication) or not published yet, there is nothing to update
+    if(!componentIndex.contains(comp.getGlobalId()))
+        return;
+
+    std::string message = "Unknown change occured to component \"" + comp.getName() + "\"\n";
+
+    DictPtr<IString, IBaseObject> eventParameters = args.getParameters();
+    
+    CoreEventId eventId = CoreEventId(args.getEventId());
+    switch(eventId) {
+        case CoreEventId::PropertyValueChanged:
+            opendaqEventHandler.updateProperty(comp, eventParameters);
+            break;
+        case CoreEventId::PropertyObjectUpdateEnd:
+            opendaqEventHandler.updateProperties(comp, eventParameters);
+            break;
+        case CoreEventId::AttributeChanged:
+            if(eventParameters.hasKey("Active")) // Active status changed
+                opendaqEventHandler.updateActiveStatus(comp, eventParameters);
+            else
                 DAQLOG_W(jetModuleLogger, message.c_str());
-                break;
-            
-        }
-    };
+            break;
+        case CoreEventId::PropertyAdded:
+            {
+                PropertyPtr property = eventParameters.get("Property");
+                if(property.getValueType() != CoreType::ctObject)
+                    componentIndex.addSetter(comp.getGlobalId(), property.getName(), JetEventHandler::compileSetter(property));
+                if(config.stateLayout == JetStateLayout::PerProperty)
+                    publishPropertyJetState(comp, property);
+                else
+                    opendaqEventHandler.addProperty(comp, eventParameters);
+            }
+            break;
+        case CoreEventId::PropertyRemoved:
+            {
+                std::string propertyName = eventParameters.get("Name");
+                std::string propertyPath = eventParameters.get("Path");
+                if(propertyPath.empty())
+                    componentIndex.removeProperty(comp.getGlobalId(), propertyName);
+                opendaqEventHandler.removeProperty(comp, eventParameters);
+            }
+            break;
+        case CoreEventId::ComponentAdded:
+        case CoreEventId::ComponentRemoved:
+            // Subtree is published or removed by JetServer, which observes core events of the whole instance
+            break;
+        default:
+            DAQLOG_W(jetModuleLogger, message.c_str());
+            break;
+        
+    }
 }
 
 /**
@@ -84,29 +148,50 @@ JetStateCallback ComponentConverter::createJetCallback()
         std::string message = "Want to change state with path: \"" + path + "\" with the value:\n" + value.toStyledString();
         DAQLOG_I(jetModuleLogger, message.c_str());
         
-        // Actual work is done on a separate thread to handle simultaneous requests. Also, otherwise "jetset" tool would time out
-        std::thread([this, value, path]() 
-        {
-            // We find component by searching relative to root device, so we have to remove its name from global ID of the component with provided path
-            std::string relativePath = jetPeerWrapper.removeRootDeviceId(path);
-            ComponentPtr component = opendaqInstance.findComponent(relativePath);
-
-            for (auto it = value.begin(); it != value.end(); ++it) {
-                std::string entryName = it.key().asString();
-                Json::Value entryValue = *it;
-
-                if(component.hasProperty(entryName)) {
-                    jetEventHandler.updateProperty(component, entryName, entryValue);
-                }
-                else if(entryName == "Active") {
-                    jetEventHandler.updateActiveStatus(component, entryValue);
-                }
-                else if(entryName == "Tags") {
-                    // TODO: Implement a function which updates tags
-                }
+        // Called on a worker of the set executor, the Jet event loop is not blocked (otherwise "jetset" tool would time out)
+        ComponentIndexEntry target;
+        if(!componentIndex.resolve(path, target)) {
+            message = "Could not find component of Jet state with path: " + path + "\n";
+            DAQLOG_E(jetModuleLogger, message.c_str());
+            throw hbk::jet::jsoncpprpcException(JM_SET_FAILED, message);
+        }
+        const ComponentPtr& component = target.component;
+
+        // Only the members which differ from the published Jet state are applied, each of them fires a core event in openDAQ.
+        // Cached Jet state has to catch up with the openDAQ events raised so far, otherwise a value which openDAQ has already
+        // changed would look unchanged.
+        opendaqEventQueue.waitForQueuedEvents();
+        Json::Value changedMembers = jetEventHandler.extractChangedMembers(value, jetPeerWrapper.getCachedJetState(path), false);
+
+        // All properties are applied in a single openDAQ update, so observers never see a half-applied Jet state
+        // and PropertyObjectUpdateEnd is the only core event fired for them
+        Json::Value errors(Json::objectValue);
+        component.beginUpdate();
+        for (auto it = changedMembers.begin(); it != changedMembers.end(); ++it) {
+            std::string entryName = it.key().asString();
+            Json::Value entryValue = *it;
+            std::string error;
+
+            JetPropertySetter setter;
+            if(componentIndex.findSetter(path, entryName, setter)) {
+                error = jetEventHandler.applySetter(setter, component, entryName, entryValue);
+            }
+            else if(component.hasProperty(entryName)) {
+                error = jetEventHandler.updateProperty(component, entryName, entryValue);
+            }
+            else if(entryName == "Active") {
+                error = jetEventHandler.updateActiveStatus(component, entryValue);
             }
+            else if(entryName == "Tags") {
+                // TODO: Implement a function which updates tags
+            }
+
+            if(!error.empty())
+                errors[entryName] = error;
+        }
+        component.endUpdate();
 
-        }).detach(); // detach is used to separate the thread of execution from the thread object, allowing execution to continue independently
+        throwSetErrors(path, errors);
 
         return Json::Value(); // Return an empty Json as there's no need to return anything specific.
         // TODO: Make sure that this is ok
@@ -127,17 +212,23 @@ JetStateCallback ComponentConverter::createObjectPropertyJetCallback()
         std::string message = "Want to change state with path: " + path + " with the value:\n" + value.toStyledString();
         DAQLOG_I(jetModuleLogger, message.c_str());
         
-        // Actual work is done on a separate thread to handle simultaneous requests. Also, otherwise "jetset" tool would time out
-        std::thread([this, value, path]() 
-        {
-            // We find component by searching relative to root device, so we have to remove its name from global ID of the component with provided path
-            std::string relativePath = jetPeerWrapper.removeRootDeviceId(path);
-            relativePath = jetPeerWrapper.removeObjectPropertyName(relativePath); // We also have to remove ObjectProperty name (string after the last slash)
-            ComponentPtr component = opendaqInstance.findComponent(relativePath);
+        // Called on a worker of the set executor, the Jet event loop is not blocked (otherwise "jetset" tool would time out)
+        ComponentIndexEntry target;
+        if(!componentIndex.resolve(path, target)) {
+            message = "Could not find component of Jet state with path: " + path + "\n";
+            DAQLOG_E(jetModuleLogger, message.c_str());
+            throw hbk::jet::jsoncpprpcException(JM_SET_FAILED, message);
+        }
 
-            jetEventHandler.updateObjectProperty(component, value);
+        // Cached Jet state has to catch up with the openDAQ events raised so far before it is compared with the request
+        opendaqEventQueue.waitForQueuedEvents();
+        Json::Value changedMembers = jetEventHandler.extractChangedMembers(value, jetPeerWrapper.getCachedJetState(path), true);
 
-        }).detach(); // detach is used to separate the thread of execution from the thread object, allowing execution to continue independently
+        // Nested properties are applied in a single openDAQ update as well, beginUpdate is propagated to the ObjectProperties
+        target.component.beginUpdate();
+        Json::Value errors = jetEventHandler.updateObjectProperty(target.component, changedMembers);
+        target.component.endUpdate();
+        throwSetErrors(path, errors);
 
         return Json::Value(); // Return an empty Json as there's no need to return anything specific.
         // TODO: Make sure that this is ok
@@ -146,6 +237,64 @@ JetStateCallback ComponentConverter::createObjectPropertyJetCallback()
     return callback;
 }
 
+/**
+ * @brief Defines a callback function for a Jet state representing a single property (JetStateLayout::PerProperty) which will be called
+ * when some change occurs in that Jet state.
+ * 
+ * @return JetStateCallback callback function which will be called during the change from Jet. It has to be passed to Jet state publisher.
+ */
+JetStateCallback ComponentConverter::createPropertyJetCallback()
+{
+    JetStateCallback callback = [this](const Json::Value& value, std::string path) -> Json::Value
+    {
+        std::string message = "Want to change state with path: " + path + " with the value:\n" + value.toStyledString();
+        DAQLOG_I(jetModuleLogger, message.c_str());
+
+        // Called on a worker of the set executor, the Jet event loop is not blocked (otherwise "jetset" tool would time out)
+        ComponentIndexEntry target;
+        if(!componentIndex.resolve(path, target)) {
+            message = "Could not find component of Jet state with path: " + path + "\n";
+            DAQLOG_E(jetModuleLogger, message.c_str());
+            throw hbk::jet::jsoncpprpcException(JM_SET_FAILED, message);
+        }
+
+        // Cached Jet state has to catch up with the openDAQ events raised so far before it is compared with the request
+        opendaqEventQueue.waitForQueuedEvents();
+        if(value == jetPeerWrapper.getCachedJetState(path))
+            return Json::Value(); // Value is already applied
+
+        Json::Value errors(Json::objectValue);
+        std::string error;
+        JetPropertySetter setter;
+        if(componentIndex.findSetter(toStdString(target.component.getGlobalId()), target.propertyName, setter))
+            error = jetEventHandler.applySetter(setter, target.component, target.propertyName, value);
+        else
+            error = jetEventHandler.updateProperty(target.component, target.propertyName, value);
+        if(!error.empty())
+            errors[target.propertyName] = error;
+        throwSetErrors(path, errors);
+
+        return Json::Value(); // Return an empty Json as there's no need to return anything specific.
+    };
+
+    return callback;
+}
+
+/**
+ * @brief Reports values of a Jet set request which could not be applied back to the Jet peer which requested the change.
+ * 
+ * @param path Path of the Jet state.
+ * @param errors Json object mapping names of the members which could not be applied to descriptions of the errors. Nothing is thrown if empty.
+ */
+void ComponentConverter::throwSetErrors(const std::string& path, const Json::Value& errors)
+{
+    if(errors.empty())
+        return;
+
+    std::string message = "Could not apply " + std::to_string(errors.size()) + " value(s) to Jet state with path: " + path;
+    throw hbk::jet::jsoncpprpcException(JM_SET_FAILED, message, errors);
+}
+
 /**
  * @brief Parses a component to get its properties which are converted into Json representation in order to be published
  * in the component's Jet state.
@@ -166,14 +315,44 @@ void ComponentConverter::appendProperties(const ComponentPtr& component, Json::V
 
             std::string path = component.getGlobalId() + "/" + property.getName();
             JetStateCallback jetStateCallback = createObjectPropertyJetCallback();
-            jetPeerWrapper.publishJetState(path, objectPropertyJetState, jetStateCallback);
+            componentIndex.addProperty(path, component, property.getName());
+            jetPeerWrapper.publishJetState(path, objectPropertyJetState, jetStateCallback, component.getGlobalId());
+        }
+        else if(config.stateLayout == JetStateLayout::PerProperty) {
+            componentIndex.addSetter(component.getGlobalId(), property.getName(), JetEventHandler::compileSetter(property));
+            publishPropertyJetState(component, property);
         }
         else {
+            componentIndex.addSetter(component.getGlobalId(), property.getName(), JetEventHandler::compileSetter(property));
             propertyManager.determinePropertyType<ComponentPtr>(component, property, parentJsonValue);
         }
     }
 }
 
+/**
+ * @brief Publishes a property as its own Jet state "<globalId>/<propertyName>". Used with JetStateLayout::PerProperty so that
+ * Jet peers interested in a single value don't have to fetch the whole component.
+ * 
+ * @param component Component which owns the property.
+ * @param property The property which is published.
+ */
+void ComponentConverter::publishPropertyJetState(const ComponentPtr& component, const PropertyPtr& property)
+{
+    std::string propertyName = property.getName();
+
+    Json::Value propertyJson;
+    propertyManager.determinePropertyType<ComponentPtr>(component, property, propertyJson);
+
+    // Callable properties are published as Jet methods, so they have no value to be published
+    if(!propertyJson.isMember(propertyName))
+        return;
+
+    std::string path = component.getGlobalId() + "/" + propertyName;
+    JetStateCallback jetStateCallback = createPropertyJetCallback();
+    componentIndex.addProperty(path, component, propertyName);
+    jetPeerWrapper.publishJetState(path, propertyJson[propertyName], jetStateCallback, component.getGlobalId());
+}
+
 /**
  * @brief Appends type of the object (e.g. Device, Channel...) to a Json object which is published as a Jet state.
  * 
@@ -0,0 +1,262 @@
+#include "component_index.h"
+#include <mutex>
+#include <vector>
+#include "jet_peer_wrapper.h"
+
+BEGIN_NAMESPACE_JET_MODULE
+
+ComponentIndex::ComponentIndex(const InstancePtr& opendaqInstance)
+    : opendaqInstance(opendaqInstance)
+{
+}
+
+/**
+ * @brief Registers a Jet state which represents a whole component.
+ * 
+ * @param path Path of the Jet state (global ID of the component).
+ * @param component Component represented by the Jet state.
+ */
+void ComponentIndex::addComponent(const std::string& path, const ComponentPtr& component)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries[path] = ComponentIndexEntry{component, std::string()};
+}
+
+/**
+ * @brief Registers a Jet state which represents a single property of a component.
+ * 
+ * @param path Path of the Jet state.
+ * @param component Component which owns the property.
+ * @param propertyName Name of the property.
+ */
+void ComponentIndex::addProperty(const std::string& path, const ComponentPtr& component, const std::string& propertyName)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries[path] = ComponentIndexEntry{component, propertyName};
+}
+
+/**
+ * @brief Registers the compiled setter of a property.
+ * 
+ * @param globalId Global ID of the component which owns the property.
+ * @param propertyName Name of the property.
+ * @param setter Setter compiled with JetEventHandler::compileSetter.
+ */
+void ComponentIndex::addSetter(const std::string& globalId, const std::string& propertyName, const JetPropertySetter& setter)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    setters[globalId + "/" + propertyName] = setter;
+}
+
+/**
+ * @brief Finds the compiled setter of a property.
+ * 
+ * @param globalId Global ID of the component which owns the property.
+ * @param propertyName Name of the property.
+ * @param setter Filled with the setter if found.
+ * @return true if the setter has been found.
+ */
+bool ComponentIndex::findSetter(const std::string& globalId, const std::string& propertyName, JetPropertySetter& setter)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = setters.find(globalId + "/" + propertyName);
+    if(it == setters.end())
+        return false;
+    setter = it->second;
+    return true;
+}
+
+/**
+ * @brief Checks whether a Jet state is currently registered in the index. Unlike resolve, openDAQ tree is not searched.
+ * 
+ * @param path Path of the Jet state.
+ * @return true if the Jet state is registered.
+ */
+bool ComponentIndex::contains(const std::string& path)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries.find(path) != entries.end();
+}
+
+/**
+ * @brief Removes a single Jet state from the index, while Jet states published below its path are kept.
+ * 
+ * @param path Path of the Jet state.
+ */
+void ComponentIndex::removeEntry(const std::string& path)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries.erase(path);
+}
+
+/**
+ * @brief Registers a subscription to the core events of a component, so that they are subscribed to only once even if the component
+ * is published multiple times.
+ * 
+ * @param globalId Global ID of the component.
+ * @param unsubscribe Function which detaches the handler from the component.
+ * @return true if the component has not been subscribed to before. Otherwise the subscription is not registered.
+ */
+bool ComponentIndex::addSubscription(const std::string& globalId, std::function<void()> unsubscribe)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return subscriptions.emplace(globalId, std::move(unsubscribe)).second;
+}
+
+/**
+ * @brief Detaches the handlers of all subscribed components. Has to be called before the objects referred to by the handlers are destroyed.
+ * 
+ */
+void ComponentIndex::removeSubscriptions()
+{
+    std::unordered_map<std::string, std::function<void()>> removedSubscriptions;
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        removedSubscriptions.swap(subscriptions);
+    }
+    // Handlers which are running at the same time may use the index
+    for(const auto& subscription : removedSubscriptions)
+        subscription.second();
+}
+
+/**
+ * @brief Removes a component, its properties and all of its descendants from the index.
+ * 
+ * @param globalId Global ID of the removed component.
+ */
+void ComponentIndex::removeComponent(const std::string& globalId)
+{
+    std::string prefix = globalId + "/";
+    std::vector<std::function<void()>> removedSubscriptions;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    for(auto it = entries.begin(); it != entries.end();) {
+        if(it->first == globalId || it->first.compare(0, prefix.size(), prefix) == 0)
+            it = entries.erase(it);
+        else
+            ++it;
+    }
+    for(auto it = setters.begin(); it != setters.end();) {
+        if(it->first.compare(0, prefix.size(), prefix) == 0)
+            it = setters.erase(it);
+        else
+            ++it;
+    }
+    for(auto it = subscriptions.begin(); it != subscriptions.end();) {
+        if(it->first == globalId || it->first.compare(0, prefix.size(), prefix) == 0) {
+            removedSubscriptions.push_back(std::move(it->second));
+            it = subscriptions.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    lock.unlock();
+
+    // Removed component object may still be alive, its events must not reach the converters anymore
+    for(const auto& unsubscribe : removedSubscriptions)
+        unsubscribe();
+}
+
+/**
+ * @brief Removes a property of a component from the index, together with its setter and Jet states published below it.
+ * 
+ * @param globalId Global ID of the component.
+ * @param propertyName Name of the removed property.
+ */
+void ComponentIndex::removeProperty(const std::string& globalId, const std::string& propertyName)
+{
+    std::string path = globalId + "/" + propertyName;
+    std::string prefix = path + "/";
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    for(auto it = entries.begin(); it != entries.end();) {
+        if(it->first == path || it->first.compare(0, prefix.size(), prefix) == 0)
+            it = entries.erase(it);
+        else
+            ++it;
+    }
+    setters.erase(path);
+}
+
+void ComponentIndex::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries.clear();
+    setters.clear();
+}
+
+/**
+ * @brief Finds the component (and property) targeted by a Jet state. Jet states which have not been registered are searched for
+ * in the openDAQ tree and added to the index.
+ * 
+ * @param path Path of the Jet state.
+ * @param entry Filled with the component and property name if found.
+ * @return true if the target has been found.
+ */
+bool ComponentIndex::resolve(const std::string& path, ComponentIndexEntry& entry)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = entries.find(path);
+        if(it != entries.end()) {
+            entry = it->second;
+            return true;
+        }
+    }
+
+    if(!findInOpendaq(path, entry))
+        return false;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries[path] = entry;
+    return true;
+}
+
+size_t ComponentIndex::size()
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries.size();
+}
+
+/**
+ * @brief Searches for the target of a Jet state in the openDAQ tree. Path is tried as global ID of a component first, then as
+ * "<globalId>/<propertyName>".
+ * 
+ * @param path Path of the Jet state.
+ * @param entry Filled with the component and property name if found.
+ * @return true if the target has been found.
+ */
+bool ComponentIndex::findInOpendaq(const std::string& path, ComponentIndexEntry& entry)
+{
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+
+    // We find component by searching relative to root device, so we have to remove its name from global ID of the component
+    ComponentPtr component = opendaqInstance.findComponent(jetPeerWrapper.removeRootDeviceId(path));
+    if(component.assigned()) {
+        entry = ComponentIndexEntry{component, std::string()};
+        return true;
+    }
+
+    std::string propertyName = path.substr(path.rfind('/') + 1);
+    component = opendaqInstance.findComponent(jetPeerWrapper.removeRootDeviceId(jetPeerWrapper.removeObjectPropertyName(path)));
+    if(component.assigned() && component.hasProperty(propertyName)) {
+        entry = ComponentIndexEntry{component, propertyName};
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Returns a copy of all registered Jet states and their targets.
+ * 
+ * @return Map of Jet state paths to their targets.
+ */
+std::unordered_map<std::string, ComponentIndexEntry> ComponentIndex::getEntries()
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries;
+}
+
+END_NAMESPACE_JET_MODULE
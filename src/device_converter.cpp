@@ -30,6 +30,7 @@ void DeviceConverter::composeJetState(const ComponentPtr& component)
 
     // Publish the component's tree structure as a Jet state
     std::string path = component.getGlobalId();
+    componentIndex.addComponent(path, component);
     jetPeerWrapper.publishJetState(path, jetState, jetStateCallback);
 }
 
@@ -29,6 +29,7 @@ void InputPortConverter::composeJetState(const ComponentPtr& component)
 
     // Publish the component's tree structure as a Jet state
     std::string path = component.getGlobalId();
+    componentIndex.addComponent(path, component);
     jetPeerWrapper.publishJetState(path, jetState, jetStateCallback);
 }
 
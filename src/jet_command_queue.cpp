@@ -0,0 +1,90 @@
+#include "jet_command_queue.h"
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Constructs a command queue and registers its wakeup notifier with the event loop.
+ * 
+ * @param eventloop Event loop on whose thread the commands are executed.
+ * @param maxBatchSize Maximum number of commands executed in one wakeup. Remaining commands are executed in the next
+ * loop iteration, so that other events handled by the event loop are not starved.
+ */
+JetCommandQueue::JetCommandQueue(hbk::sys::EventLoop& eventloop, size_t maxBatchSize)
+    : head(nullptr)
+    , tail(nullptr)
+    , wakeupPending(false)
+    , maxBatchSize(maxBatchSize)
+    , notifier(eventloop)
+{
+    // Queue always holds one already consumed node, so producers never have to touch the consumer's end of the queue
+    Node* stub = new Node();
+    head.store(stub);
+    tail = stub;
+
+    notifier.set(std::bind(&JetCommandQueue::drain, this));
+}
+
+JetCommandQueue::~JetCommandQueue()
+{
+    while(tail != nullptr) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        delete tail;
+        tail = next;
+    }
+}
+
+/**
+ * @brief Enqueues a command. Can be called from any thread, it never blocks.
+ * 
+ * @param command Command which is executed on the event loop thread.
+ */
+void JetCommandQueue::push(Command command)
+{
+    Node* node = new Node();
+    node->command = std::move(command);
+
+    Node* previous = head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+
+    wakeUp();
+}
+
+/**
+ * @brief Wakes the event loop up unless a wakeup is already pending.
+ * 
+ */
+void JetCommandQueue::wakeUp()
+{
+    if(!wakeupPending.exchange(true, std::memory_order_acq_rel))
+        notifier.notify();
+}
+
+/**
+ * @brief Executes queued commands. Called on the event loop thread when the notifier is signaled.
+ * 
+ */
+void JetCommandQueue::drain()
+{
+    // Flag is cleared before draining, so a producer which links its node after we stop reading issues a new wakeup
+    wakeupPending.store(false, std::memory_order_release);
+
+    size_t executed = 0;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    while(next != nullptr) {
+        if(executed == maxBatchSize) {
+            wakeUp();
+            return;
+        }
+
+        Command command = std::move(next->command);
+        delete tail;
+        tail = next;
+
+        command();
+        executed++;
+
+        next = tail->next.load(std::memory_order_acquire);
+    }
+}
+
+END_NAMESPACE_JET_MODULE
@@ -15,77 +15,82 @@ JetEventHandler::JetEventHandler() : jetPeerWrapper(JetPeerWrapper::getInstance(
  * @param component Component whose property value is changed.
  * @param propertyName Name of the property.
  * @param newPropertyValue Json object representing new value of the property.
+ * @return Empty string if the value has been applied, otherwise description of the reason why it has not.
  */
-void JetEventHandler::updateProperty(const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue)
+std::string JetEventHandler::updateProperty(const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue)
 {
-    PropertyPtr property = component.getProperty(propertyName);
-    bool isReadOnly = property.getReadOnly();
-    if(isReadOnly) {
-        std::string message = "Property \"" + propertyName + "\" is read-only. Its value cannot be changed. Skipping.";
-        DAQLOG_W(jetModuleLogger, message.c_str());
-        return;
-    }
+    try {
+        PropertyPtr property = component.getProperty(propertyName);
+        bool isReadOnly = property.getReadOnly();
+        if(isReadOnly) {
+            std::string message = "Property \"" + propertyName + "\" is read-only. Its value cannot be changed. Skipping.";
+            DAQLOG_W(jetModuleLogger, message.c_str());
+            return message;
+        }
 
-    CoreType propertyType = component.getProperty(propertyName).getValueType();
+        CoreType propertyType = component.getProperty(propertyName).getValueType();
 
-    std::string unsupportedPropertyType = "Update of property with CoreType " + propertyType + std::string(" is currently unsupported. Skipping.");
+        std::string unsupportedPropertyType = "Update of property with CoreType " + propertyType + std::string(" is currently unsupported. Skipping.");
 
-    switch(propertyType) {
-        case CoreType::ctBool:
-            updateSimpleProperty<bool>(component, propertyName, newPropertyValue.asBool());
-            break;
-        case CoreType::ctInt:
-            updateSimpleProperty<int64_t>(component, propertyName, newPropertyValue.asInt64());
-            break;
-        case CoreType::ctFloat:
-            updateSimpleProperty<double>(component, propertyName, newPropertyValue.asDouble());
-            break;
-        case CoreType::ctString:
-            updateSimpleProperty<std::string>(component, propertyName, newPropertyValue.asString());
-            break;
-        case CoreType::ctList:
-            updateListProperty(component, propertyName, newPropertyValue);
-            break;
-        case CoreType::ctDict:
-            updateDictProperty(component, propertyName, newPropertyValue);
-            break;
-        case CoreType::ctRatio:
-            DAQLOG_W(jetModuleLogger, unsupportedPropertyType.c_str());
-            break;
-        case CoreType::ctComplexNumber:
-            DAQLOG_W(jetModuleLogger, unsupportedPropertyType.c_str());
-            break;
-        case CoreType::ctStruct:
-            {
-                // Struct is an immutable object in openDAQ and it cannot be modified.
-                std::string message = "\"" + propertyName + "\" is StructProperty and cannot be modified.";
-                DAQLOG_E(jetModuleLogger, message.c_str());
-            }
-            break;
-        case CoreType::ctObject:
-            {
-                // ObjectProperty is represented as a separate state. It has to be updated with "updateObjectProperty" function call.
-                // This function must not be called for updating ObjectProperty!
-                std::string message = "\"" + propertyName + "\" is ObjectProperty and has to be represented as a separate state.";
-                DAQLOG_E(jetModuleLogger, message.c_str());
-            }
-            break;
-        case CoreType::ctProc:
-            {
-                std::string message = "\"" + propertyName + "\" is FunctionProperty and cannot be modified.";
-                DAQLOG_E(jetModuleLogger, message.c_str());
-            }
-            break;
-        case CoreType::ctFunc:
-            {
-                std::string message = "\"" + propertyName + "\" is FunctionProperty and cannot be modified.";
-                DAQLOG_E(jetModuleLogger, message.c_str());
-            }
-            break;
-        default:
-            DAQLOG_W(jetModuleLogger, unsupportedPropertyType.c_str());
-            break;
+        switch(propertyType) {
+            case CoreType::ctBool:
+                updateSimpleProperty<bool>(component, propertyName, newPropertyValue.asBool());
+                break;
+            case CoreType::ctInt:
+                updateSimpleProperty<int64_t>(component, propertyName, newPropertyValue.asInt64());
+                break;
+            case CoreType::ctFloat:
+                updateSimpleProperty<double>(component, propertyName, newPropertyValue.asDouble());
+                break;
+            case CoreType::ctString:
+                updateSimpleProperty<std::string>(component, propertyName, newPropertyValue.asString());
+                break;
+            case CoreType::ctList:
+                updateListProperty(component, propertyName, newPropertyValue);
+                break;
+            case CoreType::ctDict:
+                updateDictProperty(component, propertyName, newPropertyValue);
+                break;
+            case CoreType::ctRatio:
+                DAQLOG_W(jetModuleLogger, unsupportedPropertyType.c_str());
+                return unsupportedPropertyType;
+            case CoreType::ctComplexNumber:
+                DAQLOG_W(jetModuleLogger, unsupportedPropertyType.c_str());
+                return unsupportedPropertyType;
+            case CoreType::ctStruct:
+                {
+                    // Struct is an immutable object in openDAQ and it cannot be modified.
+                    std::string message = "\"" + propertyName + "\" is StructProperty and cannot be modified.";
+                    DAQLOG_E(jetModuleLogger, message.c_str());
+                    return message;
+                }
+            case CoreType::ctObject:
+                {
+                    // ObjectProperty is represented as a separate state. It has to be updated with "updateObjectProperty" function call.
+                    // This function must not be called for updating ObjectProperty!
+                    std::string message = "\"" + propertyName + "\" is ObjectProperty and has to be represented as a separate state.";
+                    DAQLOG_E(jetModuleLogger, message.c_str());
+                    return message;
+                }
+            case CoreType::ctProc:
+            case CoreType::ctFunc:
+                {
+                    std::string message = "\"" + propertyName + "\" is FunctionProperty and cannot be modified.";
+                    DAQLOG_E(jetModuleLogger, message.c_str());
+                    return message;
+                }
+            default:
+                DAQLOG_W(jetModuleLogger, unsupportedPropertyType.c_str());
+                return unsupportedPropertyType;
+        }
+    }
+    catch(...) {
+        std::string message = "Could not update property \"" + propertyName + "\": " + describeCurrentException();
+        DAQLOG_E(jetModuleLogger, message.c_str());
+        return message;
     }
+
+    return std::string();
 }
 
 /**
@@ -133,16 +138,23 @@ void JetEventHandler::updateDictProperty(const ComponentPtr& component, const st
  * 
  * @param component Component who owns the ObjectProperty.
  * @param newJsonObject New value of the whole ObjectProperty represented as a Json object.
+ * @return Json object mapping paths of the nested properties which could not be updated to descriptions of the errors.
  */
-void JetEventHandler::updateObjectProperty(const ComponentPtr& component, const Json::Value& newJsonObject)
+Json::Value JetEventHandler::updateObjectProperty(const ComponentPtr& component, const Json::Value& newJsonObject)
 {
+    Json::Value errors(Json::objectValue);
+
     // A vector of path&value pairs representing nested properties within ObjectProperty and their corresponding values
     auto pathAndValuePairs = extractObjectPropertyPathsAndValues(newJsonObject);
 
     // Updating nested property values
     for(const auto& pair : pathAndValuePairs) {
-        updateProperty(component, pair.first, pair.second);
+        std::string error = updateProperty(component, pair.first, pair.second);
+        if(!error.empty())
+            errors[pair.first] = error;
     }
+
+    return errors;
 }
 
 /**
@@ -150,10 +162,216 @@ void JetEventHandler::updateObjectProperty(const ComponentPtr& component, const
  * 
  * @param component Component whose "Active" status is changed.
  * @param newActiveStatus Json object containing new value for "Active" status.
+ * @return Empty string if the status has been applied, otherwise description of the error.
+ */
+std::string JetEventHandler::updateActiveStatus(const ComponentPtr& component, const Json::Value& newActiveStatus)
+{
+    if(!newActiveStatus.isBool())
+        return "\"Active\" has to be a boolean.";
+
+    try {
+        component.setActive(newActiveStatus.asBool());
+    }
+    catch(...) {
+        return describeCurrentException();
+    }
+    return std::string();
+}
+
+/**
+ * @brief Describes the exception which is currently being handled. Must be called from a catch block.
+ * 
+ * @return std::string with the message of the exception.
  */
-void JetEventHandler::updateActiveStatus(const ComponentPtr& component, const Json::Value& newActiveStatus)
+std::string JetEventHandler::describeCurrentException()
 {
-    component.setActive(newActiveStatus.asBool());
+    try {
+        throw;
+    }
+    catch(const std::exception& e) {
+        return e.what();
+    }
+    catch(...) {
+        return "Unknown error.";
+    }
+}
+
+/**
+ * @brief Compiles the setter of a property. It is done once when the property is published, instead of introspecting the property
+ * on every value change requested from Jet.
+ * 
+ * @param property The property for which the setter is compiled.
+ * @return JetPropertySetter of the property.
+ */
+JetPropertySetter JetEventHandler::compileSetter(const PropertyPtr& property)
+{
+    JetPropertySetter setter;
+    setter.valueType = property.getValueType();
+
+    switch(setter.valueType) {
+        case CoreType::ctBool:
+            setter.apply = &JetEventHandler::setBoolValue;
+            break;
+        case CoreType::ctInt:
+            setter.apply = &JetEventHandler::setIntValue;
+            break;
+        case CoreType::ctFloat:
+            setter.apply = &JetEventHandler::setFloatValue;
+            break;
+        case CoreType::ctString:
+            setter.apply = &JetEventHandler::setStringValue;
+            break;
+        case CoreType::ctList:
+            setter.itemType = property.getItemType();
+            setter.apply = &JetEventHandler::setListValue;
+            break;
+        case CoreType::ctDict:
+            setter.itemType = property.getItemType();
+            setter.apply = &JetEventHandler::setDictValue;
+            break;
+        default:
+            // Struct, object, function and other properties cannot be set from a component Jet state
+            setter.apply = &JetEventHandler::rejectValue;
+            break;
+    }
+
+    return setter;
+}
+
+/**
+ * @brief Applies a value received from Jet using a compiled setter.
+ * 
+ * @param setter Setter compiled for the property.
+ * @param component Component whose property value is changed.
+ * @param propertyName Name of the property.
+ * @param newPropertyValue Json object representing new value of the property.
+ * @return Empty string if the value has been applied, otherwise description of the reason why it has not.
+ */
+std::string JetEventHandler::applySetter(const JetPropertySetter& setter, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue)
+{
+    try {
+        // Read-only flag is evaluated on every change, as it can depend on the values of other properties
+        if(component.getProperty(propertyName).getReadOnly()) {
+            std::string message = "Property \"" + propertyName + "\" is read-only. Its value cannot be changed. Skipping.";
+            DAQLOG_W(jetModuleLogger, message.c_str());
+            return message;
+        }
+        return setter.apply(*this, component, propertyName, newPropertyValue, setter);
+    }
+    catch(...) {
+        std::string message = "Could not update property \"" + propertyName + "\": " + describeCurrentException();
+        DAQLOG_E(jetModuleLogger, message.c_str());
+        return message;
+    }
+}
+
+// Simple values are converted the same way as before setters were compiled (e.g. 0 and 1 are accepted as booleans).
+// Values which cannot be converted throw, which applySetter reports as an error.
+std::string JetEventHandler::setBoolValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter&)
+{
+    handler.updateSimpleProperty<bool>(component, propertyName, newPropertyValue.asBool());
+    return std::string();
+}
+
+std::string JetEventHandler::setIntValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter&)
+{
+    handler.updateSimpleProperty<int64_t>(component, propertyName, newPropertyValue.asInt64());
+    return std::string();
+}
+
+std::string JetEventHandler::setFloatValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter&)
+{
+    handler.updateSimpleProperty<double>(component, propertyName, newPropertyValue.asDouble());
+    return std::string();
+}
+
+std::string JetEventHandler::setStringValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter&)
+{
+    handler.updateSimpleProperty<std::string>(component, propertyName, newPropertyValue.asString());
+    return std::string();
+}
+
+std::string JetEventHandler::setListValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter& setter)
+{
+    if(!newPropertyValue.isArray())
+        return "Value of \"" + propertyName + "\" has to be an array.";
+    std::string error = checkItemTypes(newPropertyValue, setter.itemType);
+    if(!error.empty())
+        return "\"" + propertyName + "\": " + error;
+    handler.updateListProperty(component, propertyName, newPropertyValue);
+    return std::string();
+}
+
+std::string JetEventHandler::setDictValue(JetEventHandler& handler, const ComponentPtr& component, const std::string& propertyName, const Json::Value& newPropertyValue, const JetPropertySetter& setter)
+{
+    if(!newPropertyValue.isObject())
+        return "Value of \"" + propertyName + "\" has to be an object.";
+    std::string error = checkItemTypes(newPropertyValue, setter.itemType);
+    if(!error.empty())
+        return "\"" + propertyName + "\": " + error;
+    handler.updateDictProperty(component, propertyName, newPropertyValue);
+    return std::string();
+}
+
+std::string JetEventHandler::rejectValue(JetEventHandler&, const ComponentPtr&, const std::string& propertyName, const Json::Value&, const JetPropertySetter& setter)
+{
+    std::string message = "Value of \"" + propertyName + "\" with CoreType " + std::to_string(static_cast<int>(setter.valueType)) + " cannot be changed from Jet.";
+    DAQLOG_W(jetModuleLogger, message.c_str());
+    return message;
+}
+
+/**
+ * @brief Checks whether items of a Json array or object are compatible with the item type of a list or dict property.
+ * 
+ * @param items Json array or object.
+ * @param itemType Item type of the property. Items are not checked if it is undefined.
+ * @return Empty string if all items are compatible, otherwise description of the first incompatible item.
+ */
+std::string JetEventHandler::checkItemTypes(const Json::Value& items, CoreType itemType)
+{
+    if(itemType == CoreType::ctUndefined)
+        return std::string();
+
+    for(const auto& item : items) {
+        if(!checkTypeCompatibility(item.type(), itemType))
+            return "item " + item.toStyledString() + " is not compatible with the item type of the property.";
+    }
+    return std::string();
+}
+
+/**
+ * @brief Compares a Json object received from Jet with the currently published one and extracts the members which differ.
+ * Jet peers usually send the whole Jet state back with a single field edited, so only the extracted members have to be applied to openDAQ.
+ * 
+ * @param newJsonObject Json object received from Jet.
+ * @param currentJsonObject Json object which is currently published. Every member is treated as changed if it is not an object.
+ * @param recursive If true, nested objects are compared member by member and only their changed members are extracted.
+ * Otherwise a nested object is extracted as a whole if any of its members differ.
+ * @return Json object holding the changed members of newJsonObject.
+ */
+Json::Value JetEventHandler::extractChangedMembers(const Json::Value& newJsonObject, const Json::Value& currentJsonObject, bool recursive)
+{
+    if(!newJsonObject.isObject() || !currentJsonObject.isObject())
+        return newJsonObject;
+
+    Json::Value changedMembers(Json::objectValue);
+    for(auto it = newJsonObject.begin(); it != newJsonObject.end(); ++it) {
+        std::string key = it.name();
+        const Json::Value* currentValue = currentJsonObject.find(key.data(), key.data() + key.size());
+        if(currentValue == nullptr) {
+            changedMembers[key] = *it;
+        }
+        else if(recursive && it->isObject() && currentValue->isObject()) {
+            Json::Value nestedChanges = extractChangedMembers(*it, *currentValue, recursive);
+            if(!nestedChanges.empty())
+                changedMembers[key] = nestedChanges;
+        }
+        else if(*it != *currentValue) {
+            changedMembers[key] = *it;
+        }
+    }
+
+    return changedMembers;
 }
 
 /**
@@ -82,7 +82,7 @@ void throwJetModuleException(JetModuleException jmException)
             {
                 std::string message = "Incorrect type detected for openDAQ property";
                 std::cout << "addJetState cb: " << message << std::endl;
-                throw new hbk::jet::jsoncpprpcException(
+                throw hbk::jet::jsoncpprpcException(
                     JM_INCOMPATIBLE_TYPES,                  // code
                     message                                 // message
                     // Json::Value()                        // data
@@ -97,7 +97,7 @@ void throwJetModuleException(JetModuleException jmException)
            {
                 std::string message = "Unsupported openDAQ item";
                 std::cout << "addJetState cb: " << message << std::endl;
-                throw new hbk::jet::jsoncpprpcException(
+                throw hbk::jet::jsoncpprpcException(
                     JM_UNSUPPORTED_ITEM,                  // code
                     message                                 // message
                     // Json::Value()                        // data
@@ -115,7 +115,7 @@ void throwJetModuleException(JetModuleException jmException, std::string propert
             {
                 std::string message = "Incorrect type detected for openDAQ property: " + propertyName;
                 std::cout << "addJetState cb: " << message << std::endl;
-                throw new hbk::jet::jsoncpprpcException(
+                throw hbk::jet::jsoncpprpcException(
                     JM_INCOMPATIBLE_TYPES,                  // code
                     message                                 // message
                     // Json::Value()                        // data
@@ -139,7 +139,7 @@ void throwJetModuleException(JetModuleException jmException, Json::ValueType jso
             {
                 std::string message = "Update failed for " + propertyName + ", type: " + std::to_string(static_cast<int>(jsonValueType)) + " in " + globalId;
                 std::cout << "addJetState cb: " << message << std::endl;
-                throw new hbk::jet::jsoncpprpcException(
+                throw hbk::jet::jsoncpprpcException(
                     JM_UNSUPPORTED_JSON_TYPE,                   // code
                     message                                     // message
                     // Json::Value()                            // data
@@ -168,6 +168,14 @@ std::string jetModuleExceptionToString(const JetModuleException& jmException)
             return (message + "Arguments to the function have been provided in unsupported format.");
         case JetModuleException::JM_FUNCTION_UNSUPPORTED_RETURN_TYPE:
             return (message + "Function is defined with a return type which is not supported.");
+        case JetModuleException::JM_SET_QUEUE_FULL:
+            return (message + "Too many pending set requests, try again later.");
+        case JetModuleException::JM_SET_FAILED:
+            return (message + "Requested value could not be applied.");
+        case JetModuleException::JM_SET_TIMEOUT:
+            return (message + "Requested value has not been applied in time.");
+        case JetModuleException::JM_CALL_TIMEOUT:
+            return (message + "Method call has not finished in time.");
         default:
             return (message + "General error.");
     }
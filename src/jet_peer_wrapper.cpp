@@ -1,21 +1,207 @@
 #include "jet_peer_wrapper.h"
+#include <algorithm>
+#include <atomic>
 #include <opendaq/logger_component_factory.h>
-#include <jet/peer.hpp>
+#include <json/reader.h>
 
 BEGIN_NAMESPACE_JET_MODULE
 
-static hbk::sys::EventLoop jetStateReadEventloop;
+thread_local JetWriteScope* JetWriteScope::current = nullptr;
+
+JetWriteScope::JetWriteScope()
+    : outer(current)
+{
+    current = this;
+}
+
+/**
+ * @brief Ends the scope. Collected changes are handed to the enclosing scope, or notified if this is the outermost one.
+ * 
+ */
+JetWriteScope::~JetWriteScope()
+{
+    current = outer;
+    if(outer != nullptr) {
+        for(auto& pathAndChange : changes)
+            outer->changes[pathAndChange.first].merge(std::move(pathAndChange.second));
+    }
+    else if(!changes.empty()) {
+        JetPeerWrapper::getInstance().flushWriteScope(changes);
+    }
+}
+
+/**
+ * @brief Tells whether the calling thread is applying a value change requested from Jet.
+ * 
+ * @return true if a JetWriteScope is alive on the calling thread.
+ */
+bool JetWriteScope::isActive()
+{
+    return current != nullptr;
+}
+
+thread_local JetPublicationCapture* JetPublicationCapture::current = nullptr;
+
+JetPublicationCapture::JetPublicationCapture()
+    : JetPublicationCapture(current)
+{
+}
+
+/**
+ * @brief Constructs a capture whose publications are released to a capture of another thread. Parent has to stay active
+ * until this capture is released.
+ * 
+ * @param parent Capture to which publications are released, or nullptr to release them to the Jet event loop.
+ */
+JetPublicationCapture::JetPublicationCapture(JetPublicationCapture* parent)
+    : previous(current)
+    , parent(parent)
+    , active(true)
+{
+    current = this;
+}
+
+JetPublicationCapture::~JetPublicationCapture()
+{
+    release();
+}
+
+/**
+ * @brief Deactivates the capture. Publications issued afterwards are sent directly. Has to be called on the thread which created the capture.
+ * 
+ */
+void JetPublicationCapture::end()
+{
+    if(!active)
+        return;
+    active = false;
+    if(current == this)
+        current = previous;
+}
+
+/**
+ * @brief Deactivates the capture and hands the captured publications to the Jet event loop (or to the parent capture), in the order
+ * in which they were issued.
+ * 
+ */
+void JetPublicationCapture::release()
+{
+    end();
+    if(publications.empty())
+        return;
+
+    std::vector<CapturedPublication> released;
+    released.swap(publications);
+    if(parent != nullptr && parent->active) {
+        parent->publications.insert(parent->publications.end(), released.begin(), released.end());
+        for(const auto& publication : released)
+            parent->paths.push_back(publication.path);
+        return;
+    }
+    JetPeerWrapper::getInstance().jetCommandQueue.push([released]() {
+        for(const auto& publication : released)
+            publication.command();
+    });
+}
+
+/**
+ * @brief Drops captured publications of the given paths, so they are never sent (e.g. because the Jet states are already published).
+ * 
+ * @param discardedPaths Paths whose publications are dropped.
+ */
+void JetPublicationCapture::discard(const std::set<std::string>& discardedPaths)
+{
+    size_t cancelled = 0;
+    for(auto it = publications.begin(); it != publications.end();) {
+        if(discardedPaths.count(it->path) > 0) {
+            cancelled += it->count;
+            it = publications.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    if(cancelled > 0)
+        JetPeerWrapper::getInstance().cancelPublications(cancelled);
+}
+
+/**
+ * @brief Returns the capture which is active on the current thread.
+ * 
+ * @return Pointer to the capture, or nullptr if publications are sent directly.
+ */
+JetPublicationCapture* JetPublicationCapture::getActive()
+{
+    return current;
+}
+
+/**
+ * @brief Returns the number of captured publications which have not been released yet.
+ * 
+ * @return Number of publications.
+ */
+size_t JetPublicationCapture::size() const
+{
+    return publications.size();
+}
+
+/**
+ * @brief Returns paths of the Jet states and methods published while the capture was active.
+ * 
+ * @return Vector of paths in the order in which they were published.
+ */
+const std::vector<std::string>& JetPublicationCapture::getPaths() const
+{
+    return paths;
+}
+
+/**
+ * @brief Merges a later change of the same Jet state into this one. Latest value is kept, while changed and removed members accumulate.
+ * 
+ * @param change Later change of the Jet state.
+ */
+void JetStateChange::merge(JetStateChange change)
+{
+    jetState = std::move(change.jetState);
+    for(const auto& key : change.changedKeys) {
+        changedKeys.insert(key);
+        removedKeys.erase(key);
+    }
+    for(const auto& key : change.removedKeys) {
+        removedKeys.insert(key);
+        changedKeys.erase(key);
+    }
+}
 
 JetPeerWrapper::JetPeerWrapper()
+    : jetCommandQueue(jetEventloop)
+    , coalescingWindow(0)
+    , coalescingMaxPending(0)
+    , coalescingTimer(jetEventloop)
+    , deltaBaselineThreshold(0)
+    , maxPublicationsInFlight(0)
+    , publicationsInFlight(0)
+    , synchronousSetTimeout(0)
+    , methodCallTimeout(JET_METHOD_CALL_TIMEOUT)
+    , jetClientCommandQueue(jetClientEventloop)
 {
     jetEventloopRunning = false; // TODO: This probably has to be removed
+    deltaNotificationsEnabled = false;
 
-    startJetEventloopThread();
+    // Peer is created before the event loop thread is started, afterwards it is only used from the event loop thread
     jetPeer = new hbk::jet::PeerAsync(jetEventloop, hbk::jet::JET_UNIX_DOMAIN_SOCKET_NAME, 0);
+    startJetEventloopThread();
+
+    // Reader peer is connected once and kept alive for the whole lifetime of the wrapper
+    jetClientEventloopRunning = false;
+    jetClientPeer = new hbk::jet::PeerAsync(jetClientEventloop, "127.0.0.1", hbk::jet::JETD_TCP_PORT);
+    startJetClientEventloop();
 }
 
 JetPeerWrapper::~JetPeerWrapper()
 {
+    stopJetClientEventloop();
+    delete(jetClientPeer);
     stopJetEventloop();
     delete(jetPeer);
 }
@@ -26,10 +212,220 @@ JetPeerWrapper::~JetPeerWrapper()
  * @param path 
  * @param jetState Path which the Jet state will have.
  * @param callback Callback function which will be called when the Jet state is modified.
+ * @param setLane Key of the set executor lane in which the callback is executed. Changes requested in one lane are applied in arrival order.
+ * Jet states belonging to the same component should share the lane. Path of the Jet state is used if empty.
+ */
+void JetPeerWrapper::publishJetState(const std::string& path, const Json::Value& jetState, JetStateCallback callback, const std::string& setLane)
+{
+    std::lock_guard<std::mutex> lock(jetStateCacheMutex);
+    JetStateChange change;
+    replaceCachedJetState(jetStateCache[path], jetState, change);
+
+    JetPublication publication;
+    publication.path = path;
+    publication.stateCallback = dispatchToSetExecutor(callback, setLane.empty() ? path : setLane);
+    // Jet states which are not objects (e.g. a single property) have no members which could be sent as a delta
+    publication.withDelta = deltaNotificationsEnabled && jetState.isObject();
+
+    beginPublications(publication.withDelta ? 2 : 1);
+    pushPublication(publication);
+}
+
+/**
+ * @brief Hands a publication to the Jet event loop, or to the publication capture which is active on the current thread.
+ * 
+ * @param publication Jet state or method to be published.
+ */
+void JetPeerWrapper::pushPublication(const JetPublication& publication)
+{
+    std::function<void()> command = [this, publication]() {
+        queuePublication(publication);
+    };
+
+    if(JetPublicationCapture::current != nullptr) {
+        size_t count = publication.withDelta ? 2 : 1;
+        JetPublicationCapture::current->publications.push_back({publication.path, count, std::move(command)});
+        JetPublicationCapture::current->paths.push_back(publication.path);
+        return;
+    }
+    jetCommandQueue.push(std::move(command));
+}
+
+/**
+ * @brief Wraps a Jet state callback so that it is executed by the set executor instead of the Jet event loop thread.
+ * The wrapped callback returns as soon as the request is queued, so clients like "jetset" don't time out.
+ * 
+ * @param callback Callback function which applies the requested value.
+ * @param lane Key of the set executor lane in which the callback is executed.
+ * @return JetStateCallback which queues the callback. It reports an error to the Jet client if the request is rejected.
+ */
+JetStateCallback JetPeerWrapper::dispatchToSetExecutor(JetStateCallback callback, const std::string& lane)
+{
+    if(!callback)
+        return callback;
+
+    return [this, callback, lane](const Json::Value& value, const std::string& path) -> Json::Value
+    {
+        // Outcome of the request is only waited for in synchronous mode. Whoever clears "awaited" first owns reporting a failure:
+        // the worker hands it to the waiting Jet event loop, or logs it if nobody waits (anymore).
+        struct SetOutcome
+        {
+            std::promise<void> promise;
+            std::atomic<bool> awaited;
+        };
+        auto outcome = std::make_shared<SetOutcome>();
+        outcome->awaited = (synchronousSetTimeout.count() != 0);
+        std::future<void> future = outcome->promise.get_future();
+
+        // Switching a component on or off must not wait behind bulk property writes
+        JetSetPriority priority = changesActiveStatus(path, value) ? JetSetPriority::High : JetSetPriority::Low;
+        bool queued = setExecutor.submit(lane, [callback, value, path, outcome]() {
+            try {
+                // Changes which openDAQ reports back while the value is being applied are notified once, after the callback returns
+                JetWriteScope writeScope;
+                callback(value, path);
+                outcome->promise.set_value();
+            }
+            catch(...) {
+                if(!outcome->awaited.exchange(false)) {
+                    std::string message = "Jet set request failed for Jet state with path: " + path + ": " + describeException(std::current_exception()) + "\n";
+                    DAQLOG_E(jetModuleLogger, message.c_str());
+                }
+                outcome->promise.set_exception(std::current_exception());
+            }
+        }, priority);
+        if(!queued) {
+            std::string message = "Rejected change of Jet state with path: " + path + ", set queue is full.\n";
+            DAQLOG_W(jetModuleLogger, message.c_str());
+            throw hbk::jet::jsoncpprpcException(JM_SET_QUEUE_FULL, jetModuleExceptionToString(JM_SET_QUEUE_FULL));
+        }
+
+        if(synchronousSetTimeout.count() == 0)
+            return Json::Value();
+
+        // Failure which the worker has already claimed is waited for, it is about to be set
+        if(future.wait_for(synchronousSetTimeout) != std::future_status::ready && outcome->awaited.exchange(false))
+            throw hbk::jet::jsoncpprpcException(JM_SET_TIMEOUT, jetModuleExceptionToString(JM_SET_TIMEOUT));
+
+        try {
+            future.get();
+        }
+        catch(const hbk::jet::jsoncpprpcException&) {
+            throw;
+        }
+        catch(...) {
+            throw hbk::jet::jsoncpprpcException(JM_SET_FAILED, describeException(std::current_exception()));
+        }
+
+        // Applied values are notified by the echo of the change, answering with them as well would notify the Jet state twice
+        return Json::Value();
+    };
+}
+
+/**
+ * @brief Wraps a Jet method callback so that it is executed by a high-priority worker of the set executor, ahead of bulk value changes.
+ * Jet event loop waits for the result at most for the method call timeout.
+ * 
+ * @param callback Callback function which executes the method.
+ * @param lane Key of the set executor lane in which the callback is executed.
+ * @return JetMethodCallback which executes the callback and returns its result, or throws the exception thrown by the callback.
+ */
+JetMethodCallback JetPeerWrapper::dispatchMethodToSetExecutor(JetMethodCallback callback, const std::string& lane)
+{
+    if(!callback)
+        return callback;
+
+    return [this, callback, lane](const Json::Value& args) -> Json::Value
+    {
+        auto result = std::make_shared<std::promise<Json::Value>>();
+        std::future<Json::Value> future = result->get_future();
+
+        // Exception is not rethrown in the worker, it is handed over to the Jet event loop which reports it to the caller
+        bool queued = setExecutor.submit(lane, [callback, args, result]() {
+            try {
+                JetWriteScope writeScope;
+                result->set_value(callback(args));
+            }
+            catch(...) {
+                result->set_exception(std::current_exception());
+            }
+        }, JetSetPriority::High);
+        if(!queued)
+            return callback(args); // Executor is being reconfigured
+
+        if(future.wait_for(methodCallTimeout) != std::future_status::ready)
+            throw hbk::jet::jsoncpprpcException(JM_CALL_TIMEOUT, jetModuleExceptionToString(JM_CALL_TIMEOUT));
+        return future.get();
+    };
+}
+
+/**
+ * @brief Checks whether a value change requested from Jet switches the "Active" status of a component.
+ * 
+ * @param path Path of the Jet state.
+ * @param value Requested value.
+ * @return true if the value holds an "Active" member which differs from the cached Jet state.
+ */
+bool JetPeerWrapper::changesActiveStatus(const std::string& path, const Json::Value& value)
+{
+    if(!value.isObject() || !value.isMember("Active"))
+        return false;
+
+    std::lock_guard<std::mutex> lock(jetStateCacheMutex);
+    auto it = jetStateCache.find(path);
+    if(it == jetStateCache.end() || !it->second.isObject())
+        return true;
+    return it->second.get("Active", Json::Value()) != value["Active"];
+}
+
+/**
+ * @brief Sets how long the Jet event loop waits for the result of a Jet method executed by the set executor.
+ * 
+ * @param timeout Maximum time to wait. Caller receives an error if the method doesn't finish in time.
  */
-void JetPeerWrapper::publishJetState(const std::string& path, const Json::Value& jetState, JetStateCallback callback)
+void JetPeerWrapper::setMethodCallTimeout(std::chrono::milliseconds timeout)
 {
-    jetPeer->addStateAsync(path, jetState, hbk::jet::responseCallback_t(), callback);
+    jetCommandQueue.push([this, timeout]() {
+        methodCallTimeout = timeout;
+    });
+}
+
+/**
+ * @brief Enables waiting for value changes requested from Jet to be applied before the request is answered. The Jet peer then receives
+ * an error describing the values which could not be applied, while the applied values are notified as usual.
+ * Jet state callbacks are answered by their return value, so the Jet event loop is blocked while waiting and the timeout has to be
+ * shorter than the timeout of the requesting peer.
+ * 
+ * @param timeout Time to wait for a change to be applied. Zero answers requests immediately once they are queued.
+ */
+void JetPeerWrapper::setSynchronousSets(std::chrono::milliseconds timeout)
+{
+    jetCommandQueue.push([this, timeout]() {
+        synchronousSetTimeout = timeout;
+    });
+}
+
+/**
+ * @brief Configures the pool of worker threads which applies value changes requested from Jet.
+ * 
+ * @param threadCount Number of worker threads.
+ * @param priorityThreadCount Number of additional worker threads reserved for Jet method calls and "Active" status changes.
+ * @param queueCapacity Maximum number of bulk requests waiting for a worker. Zero means unlimited.
+ * @param overflowPolicy What happens to a bulk request while the queue is full.
+ */
+void JetPeerWrapper::configureSetExecutor(size_t threadCount, size_t priorityThreadCount, size_t queueCapacity, JetSetOverflowPolicy overflowPolicy)
+{
+    setExecutor.configure(threadCount, priorityThreadCount, queueCapacity, overflowPolicy);
+}
+
+/**
+ * @brief Returns the counters of the pool of worker threads which applies value changes requested from Jet.
+ * 
+ * @return JetSetExecutorStatistics object.
+ */
+JetSetExecutorStatistics JetPeerWrapper::getSetExecutorStatistics()
+{
+    return setExecutor.getStatistics();
 }
 
 /**
@@ -40,7 +436,12 @@ void JetPeerWrapper::publishJetState(const std::string& path, const Json::Value&
  */
 void JetPeerWrapper::publishJetMethod(const std::string& path, JetMethodCallback callback)
 {
-    jetPeer->addMethodAsync(path, hbk::jet::responseCallback_t(), callback);
+    JetPublication publication;
+    publication.path = path;
+    publication.methodCallback = dispatchMethodToSetExecutor(callback, path);
+
+    beginPublications(1);
+    pushPublication(publication);
 }
 
 /**
@@ -50,7 +451,210 @@ void JetPeerWrapper::publishJetMethod(const std::string& path, JetMethodCallback
  */
 void JetPeerWrapper::removeJetMethod(const std::string& path)
 {
-    jetPeer->removeMethodAsync(path);
+    jetCommandQueue.push([this, path]() {
+        // Method which is still waiting in the publication queue is never sent, so there is nothing to remove from jetd
+        auto it = std::find_if(publicationQueue.begin(), publicationQueue.end(), [&path](const JetPublication& publication) {
+            return publication.path == path && publication.methodCallback;
+        });
+        if(it != publicationQueue.end()) {
+            publicationQueue.erase(it);
+            if(--unsentPublicationPaths[path] == 0)
+                unsentPublicationPaths.erase(path);
+            cancelPublications(1);
+            return;
+        }
+
+        publishedMethodPaths.erase(path);
+        jetPeer->removeMethodAsync(path);
+    });
+}
+
+/**
+ * @brief Removes a Jet state together with every Jet state and method published below its path (e.g. Jet states of the children
+ * of a removed component). Publications which have not been sent yet are dropped.
+ * 
+ * @param path Path of the Jet state which is removed. It doesn't have to be a Jet state itself.
+ * @param recursive If false, only the Jet state or method with exactly this path is removed.
+ */
+void JetPeerWrapper::removeJetStates(const std::string& path, bool recursive)
+{
+    auto matches = [path, recursive](const std::string& candidate) {
+        return recursive ? isInSubtree(candidate, path) : candidate == path;
+    };
+
+    std::vector<std::string> removedStates;
+    {
+        std::lock_guard<std::mutex> lock(jetStateCacheMutex);
+        for(auto it = jetStateCache.begin(); it != jetStateCache.end();) {
+            if(matches(it->first)) {
+                removedStates.push_back(it->first);
+                it = jetStateCache.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    jetCommandQueue.push([this, matches, removedStates]() {
+        // Publications still waiting in the queue are never sent, so there is nothing to remove from jetd
+        std::set<std::string> unsentPaths;
+        size_t cancelled = 0;
+        for(auto it = publicationQueue.begin(); it != publicationQueue.end();) {
+            if(matches(it->path)) {
+                unsentPaths.insert(it->path);
+                cancelled += it->withDelta ? 2 : 1;
+                it = publicationQueue.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        for(const auto& unsentPath : unsentPaths)
+            unsentPublicationPaths.erase(unsentPath);
+        if(cancelled > 0)
+            cancelPublications(cancelled);
+
+        // Pending notifications would be sent to Jet states which no longer exist
+        for(auto it = pendingNotifications.begin(); it != pendingNotifications.end();) {
+            if(matches(it->first))
+                it = pendingNotifications.erase(it);
+            else
+                ++it;
+        }
+        pendingNotificationOrder.erase(std::remove_if(pendingNotificationOrder.begin(), pendingNotificationOrder.end(), matches),
+                                       pendingNotificationOrder.end());
+
+        for(const auto& statePath : removedStates) {
+            if(unsentPaths.count(statePath) == 0)
+                jetPeer->removeStateAsync(statePath);
+            if(jetStateDeltas.erase(statePath) > 0)
+                jetPeer->removeStateAsync(statePath + JET_DELTA_STATE_SUFFIX);
+        }
+
+        for(auto it = publishedMethodPaths.begin(); it != publishedMethodPaths.end();) {
+            if(matches(*it)) {
+                jetPeer->removeMethodAsync(*it);
+                it = publishedMethodPaths.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    });
+}
+
+/**
+ * @brief Notifies the whole cached value of a Jet state, e.g. after it has been replaced without notification.
+ * 
+ * @param path Path of the Jet state.
+ */
+void JetPeerWrapper::refreshJetState(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(jetStateCacheMutex);
+    auto it = jetStateCache.find(path);
+    if(it == jetStateCache.end())
+        return;
+
+    JetStateChange change;
+    change.jetState = it->second;
+    if(change.jetState.isObject()) {
+        for(const auto& key : change.jetState.getMemberNames())
+            change.changedKeys.insert(key);
+    }
+    queueJetStateNotification(path, std::move(change));
+}
+
+/**
+ * @brief Checks whether a path equals the root path or lies below it.
+ * 
+ * @param path Checked path.
+ * @param rootPath Root of the subtree.
+ * @return true if path is rootPath or starts with "<rootPath>/".
+ */
+bool JetPeerWrapper::isInSubtree(const std::string& path, const std::string& rootPath)
+{
+    if(path.compare(0, rootPath.size(), rootPath) != 0)
+        return false;
+    return path.size() == rootPath.size() || path[rootPath.size()] == '/';
+}
+
+/**
+ * @brief Describes an exception captured by a worker of the set executor.
+ * 
+ * @param exception The captured exception.
+ * @return std::string with the message of the exception.
+ */
+std::string JetPeerWrapper::describeException(std::exception_ptr exception)
+{
+    try {
+        std::rethrow_exception(exception);
+    }
+    catch(const std::exception& e) {
+        return e.what();
+    }
+    catch(...) {
+        return "Unknown error.";
+    }
+}
+
+/**
+ * @brief Sets the maximum number of publications which are sent to jetd without being acknowledged. Further publications wait
+ * in a queue and are sent as acknowledgements arrive, so that publishing a large tree does not flood jetd's socket buffer.
+ * 
+ * @param maxInFlight Maximum number of unacknowledged publications. Zero means unlimited.
+ */
+void JetPeerWrapper::setMaxPublicationsInFlight(size_t maxInFlight)
+{
+    jetCommandQueue.push([this, maxInFlight]() {
+        maxPublicationsInFlight = maxInFlight;
+        sendQueuedPublications();
+    });
+}
+
+/**
+ * @brief Adds a publication to the publication queue and sends as many queued publications as the in-flight window allows.
+ * Must be called on the event loop thread.
+ * 
+ * @param publication Jet state or method which is published.
+ */
+void JetPeerWrapper::queuePublication(const JetPublication& publication)
+{
+    publicationQueue.push_back(publication);
+    unsentPublicationPaths[publication.path]++;
+    sendQueuedPublications();
+}
+
+/**
+ * @brief Sends queued publications until the in-flight window is full. Must be called on the event loop thread.
+ * 
+ */
+void JetPeerWrapper::sendQueuedPublications()
+{
+    while(!publicationQueue.empty() && (maxPublicationsInFlight == 0 || publicationsInFlight < maxPublicationsInFlight)) {
+        JetPublication publication = std::move(publicationQueue.front());
+        publicationQueue.pop_front();
+        if(--unsentPublicationPaths[publication.path] == 0)
+            unsentPublicationPaths.erase(publication.path);
+
+        if(publication.methodCallback) {
+            publicationsInFlight++;
+            publishedMethodPaths.insert(publication.path);
+            jetPeer->addMethodAsync(publication.path, trackPublication(publication.path), publication.methodCallback);
+            continue;
+        }
+
+        // Jet state is sent with its latest value, changes made while it was queued have not been notified
+        publicationsInFlight++;
+        jetPeer->addStateAsync(publication.path, getCachedJetState(publication.path), trackPublication(publication.path), publication.stateCallback);
+        if(publication.withDelta) {
+            // Companion Jet state is read-only, changes are requested through the Jet state itself
+            std::string deltaPath = publication.path + JET_DELTA_STATE_SUFFIX;
+            jetStateDeltas[publication.path] = JetStateDelta();
+            publicationsInFlight++;
+            jetPeer->addStateAsync(deltaPath, composeDeltaDocument(jetStateDeltas[publication.path]), trackPublication(deltaPath), hbk::jet::stateCallback_t());
+        }
+    }
 }
 
 /**
@@ -61,28 +665,11 @@ void JetPeerWrapper::removeJetMethod(const std::string& path)
  */
 Json::Value JetPeerWrapper::readJetState(const std::string& path)
 {
-    std::string address("127.0.0.1"); // localhost
-    unsigned int port = hbk::jet::JETD_TCP_PORT;
-
     // We want to get a Jet state with provided path only
     hbk::jet::matcher_t match;
     match.equals = path;
 
-    hbk::jet::PeerAsync jetStateReaderPeer(jetStateReadEventloop, address, port);
-
-    // Create a promise and future
-    std::promise<Json::Value> promise;
-    std::future<Json::Value> future = promise.get_future();
-
-    // Calls the callback function with the promise
-    jetStateReaderPeer.getAsync(match, [&promise](const Json::Value& value) {
-        readJetStateCb(promise, value);
-    });
-
-    jetStateReadEventloop.execute();
-
-    // Wait for the future to get the value
-    Json::Value jetState = future.get();
+    Json::Value jetState = readJetStates(match);
 
     // Making sure that size of the array of Json objects is exactly 1
     if(jetState.size() == 0) {
@@ -107,25 +694,37 @@ Json::Value JetPeerWrapper::readJetState(const std::string& path)
  */
 Json::Value JetPeerWrapper::readAllJetStates()
 {
-    std::string address("127.0.0.1");
-    unsigned int port = hbk::jet::JETD_TCP_PORT;
     hbk::jet::matcher_t match;
-    hbk::jet::PeerAsync peer(jetStateReadEventloop, address, port);
+    return readJetStates(match);
+}
 
-    // Create a promise and future
-    std::promise<Json::Value> promise;
-    std::future<Json::Value> future = promise.get_future();
+/**
+ * @brief Reads Jet states matching the provided matcher using the long-lived reader peer. The request is posted to the reader
+ * event loop and this function blocks until the response arrives or JET_STATE_READ_TIMEOUT expires.
+ * 
+ * @param match Matcher which selects the Jet states to be read.
+ * @return Json::Value array of path&value pairs. Empty Json value is returned on timeout.
+ */
+Json::Value JetPeerWrapper::readJetStates(const hbk::jet::matcher_t& match)
+{
+    // Every request owns its promise, so responses can't be mixed up between concurrent readers
+    auto promise = std::make_shared<std::promise<Json::Value>>();
+    std::future<Json::Value> future = promise->get_future();
 
-    // Calls the callback function with the promise
-    peer.getAsync(match, [&promise](const Json::Value& value) {
-        readJetStateCb(promise, value);
+    jetClientCommandQueue.push([this, match, promise]() {
+        jetClientPeer->getAsync(match, [promise](const Json::Value& value) {
+            // value contains the data as an array of objects
+            promise->set_value(value[hbk::jsonrpc::RESULT]);
+        });
     });
 
-    jetStateReadEventloop.execute();
+    if(future.wait_for(std::chrono::seconds(JET_STATE_READ_TIMEOUT)) != std::future_status::ready) {
+        std::string message = "Timed out while reading Jet states from jetd.\n";
+        DAQLOG_E(jetModuleLogger, message.c_str());
+        return Json::Value();
+    }
 
-    // Wait for the future to get the value
-    Json::Value result = future.get();
-    return result;
+    return future.get();
 }
 
 /**
@@ -136,23 +735,421 @@ Json::Value JetPeerWrapper::readAllJetStates()
  */
 void JetPeerWrapper::updateJetState(const std::string& path, const Json::Value newValue)
 {
-    jetPeer->notifyState(path, newValue);
+    std::lock_guard<std::mutex> lock(jetStateCacheMutex);
+
+    Json::Value& cachedJetState = jetStateCache[path];
+    if(!newValue.isObject() && cachedJetState == newValue)
+        return;
+
+    JetStateChange change;
+    replaceCachedJetState(cachedJetState, newValue, change);
+
+    // Nothing to notify if none of the members of the new value differs from the current one
+    if(newValue.isObject() && change.changedKeys.empty() && change.removedKeys.empty())
+        return;
+
+    queueJetStateNotification(path, std::move(change));
+}
+
+/**
+ * @brief Sets a single value inside of a published Jet state and notifies the change. The value is patched in the local copy
+ * of the Jet state, so there is no need to read the Jet state from jetd beforehand.
+ * 
+ * @param path Path of the Jet state.
+ * @param valuePath Keys leading to the value inside of the Jet state (e.g. {"ObjectProperty", "NestedProperty"}).
+ * @param newValue New value which is set at the end of valuePath.
+ */
+void JetPeerWrapper::updateJetStateValue(const std::string& path, const std::vector<std::string>& valuePath, const Json::Value& newValue)
+{
+    if(valuePath.empty())
+        return;
+
+    // Lock is held until notification is queued, so that notifications for the same path are sent in the same order as the patches
+    std::unique_lock<std::mutex> lock(jetStateCacheMutex);
+
+    auto it = jetStateCache.find(path);
+    if(it == jetStateCache.end()) {
+        // Jet state was not published by this peer. Its current value is read from jetd only once to seed the local copy.
+        // Reading may take until the read timeout, so other Jet states can be updated meanwhile.
+        lock.unlock();
+        std::string message = "Jet state with path \"" + path + "\" is not cached. Reading it from jetd.\n";
+        DAQLOG_W(jetModuleLogger, message.c_str());
+        Json::Value jetState = readJetState(path);
+        lock.lock();
+
+        // Jet state published or seeded by another thread in the meantime is newer than the value read, so it is kept
+        it = jetStateCache.emplace(path, std::move(jetState)).first;
+    }
+    Json::Value& cachedJetState = it->second;
+
+    // Only the patched value is compared. If it is already present with the same value, there is nothing to notify
+    const Json::Value* existingJsonVal = &cachedJetState;
+    for(const auto& key : valuePath) {
+        if(existingJsonVal == nullptr || !existingJsonVal->isObject() || !existingJsonVal->isMember(key))
+            existingJsonVal = nullptr;
+        else
+            existingJsonVal = &((*existingJsonVal)[key]);
+    }
+    if(existingJsonVal != nullptr && *existingJsonVal == newValue)
+        return;
+
+    Json::Value* currentJsonVal = &cachedJetState;
+    for(const auto& key : valuePath)
+        currentJsonVal = &((*currentJsonVal)[key]);
+    *currentJsonVal = newValue;
+
+    JetStateChange change;
+    change.jetState = cachedJetState;
+    change.changedKeys.insert(valuePath[0]);
+
+    queueJetStateNotification(path, std::move(change));
+}
+
+/**
+ * @brief Configures merging of rapid notifications of the same Jet state. When a component changes many properties in a burst,
+ * subscribers receive one notification with the latest value instead of one notification per change.
+ * 
+ * @param window Time window within which notifications of the same Jet state are merged. Zero disables coalescing.
+ * @param maxPending Number of distinct pending Jet states which triggers a flush before the window expires.
+ */
+void JetPeerWrapper::setNotificationCoalescing(std::chrono::milliseconds window, size_t maxPending)
+{
+    jetCommandQueue.push([this, window, maxPending]() {
+        coalescingWindow = window;
+        coalescingMaxPending = maxPending;
+        if(coalescingWindow.count() == 0)
+            flushJetStateNotifications();
+    });
+}
+
+/**
+ * @brief Enables publishing of changes as small delta documents instead of whole Jet states. Every object Jet state published afterwards
+ * gets a read-only companion Jet state "<path>/_delta". The companion holds the members changed since the last full notification
+ * of the Jet state, so the current value is always the Jet state merged with its delta document. The cost of an update then
+ * scales with what has changed and not with the size of the component.
+ * Must be called before the Jet states are published.
+ * 
+ * @param enabled Whether delta notifications are used.
+ * @param baselineThreshold Number of changed members in a delta document after which the whole Jet state is notified again
+ * and the delta document is reset.
+ */
+void JetPeerWrapper::setDeltaNotifications(bool enabled, size_t baselineThreshold)
+{
+    {
+        std::lock_guard<std::mutex> lock(jetStateCacheMutex);
+        deltaNotificationsEnabled = enabled;
+    }
+    jetCommandQueue.push([this, baselineThreshold]() {
+        deltaBaselineThreshold = baselineThreshold;
+    });
+}
+
+/**
+ * @brief Queues a notification of a changed Jet state to the event loop. If the change is an echo of a value change requested from Jet
+ * (JetWriteScope is active on the calling thread), it is collected and sent when the scope ends.
+ * 
+ * @param path Path of the Jet state.
+ * @param change New value of the Jet state with the changed members.
+ */
+void JetPeerWrapper::queueJetStateNotification(const std::string& path, JetStateChange change)
+{
+    if(JetWriteScope::current != nullptr) {
+        JetStateChange& collected = JetWriteScope::current->changes[path];
+        collected.merge(std::move(change));
+        return;
+    }
+
+    jetCommandQueue.push([this, path, change]() {
+        notifyJetState(path, change);
+    });
+}
+
+/**
+ * @brief Queues notifications of the Jet states changed within a JetWriteScope.
+ * 
+ * @param changes Collected changes of Jet states.
+ */
+void JetPeerWrapper::flushWriteScope(std::map<std::string, JetStateChange>& changes)
+{
+    // Other threads may have changed the Jet states meanwhile, so the notification carries the latest local copy
+    std::lock_guard<std::mutex> lock(jetStateCacheMutex);
+    for(auto& pathAndChange : changes) {
+        auto it = jetStateCache.find(pathAndChange.first);
+        if(it != jetStateCache.end())
+            pathAndChange.second.jetState = it->second;
+
+        std::string path = pathAndChange.first;
+        JetStateChange change = std::move(pathAndChange.second);
+        jetCommandQueue.push([this, path, change]() {
+            notifyJetState(path, change);
+        });
+    }
+}
+
+/**
+ * @brief Notifies a change of a Jet state or keeps it pending if coalescing is enabled. Must be called on the event loop thread.
+ * 
+ * @param path Path of the Jet state.
+ * @param change New value of the Jet state with the changed members.
+ */
+void JetPeerWrapper::notifyJetState(const std::string& path, JetStateChange change)
+{
+    if(coalescingWindow.count() == 0) {
+        sendJetStateNotification(path, change);
+        return;
+    }
+
+    auto it = pendingNotifications.find(path);
+    if(it == pendingNotifications.end()) {
+        pendingNotifications.emplace(path, std::move(change));
+        pendingNotificationOrder.push_back(path);
+    }
+    else {
+        // Only the latest value is notified, but all members changed within the window have to be part of the delta
+        it->second.merge(std::move(change));
+    }
+
+    if(pendingNotifications.size() >= coalescingMaxPending) {
+        flushJetStateNotifications();
+    }
+    else if(!coalescingTimer.isRunning()) {
+        coalescingTimer.set(coalescingWindow, false, [this](bool fired) {
+            if(fired)
+                flushJetStateNotifications();
+        });
+    }
+}
+
+/**
+ * @brief Sends a notification of a Jet state. In delta mode the changed members are merged into the delta document of the Jet state
+ * and only the delta document is notified, unless it grew above the threshold. Must be called on the event loop thread.
+ * 
+ * @param path Path of the Jet state.
+ * @param change New value of the Jet state with the changed members.
+ */
+void JetPeerWrapper::sendJetStateNotification(const std::string& path, const JetStateChange& change)
+{
+    // Jet state which is still waiting in the publication queue is added with its latest value once it is sent
+    if(unsentPublicationPaths.count(path) != 0)
+        return;
+
+    auto it = jetStateDeltas.find(path);
+    if(it == jetStateDeltas.end() || !change.jetState.isObject()) {
+        jetPeer->notifyState(path, change.jetState);
+        return;
+    }
+
+    JetStateDelta& delta = it->second;
+    for(const auto& key : change.changedKeys) {
+        delta.changed[key] = change.jetState[key];
+        delta.removed.erase(key);
+    }
+    for(const auto& key : change.removedKeys) {
+        delta.changed.removeMember(key);
+        delta.removed.insert(key);
+    }
+
+    if(delta.changed.size() + delta.removed.size() > deltaBaselineThreshold) {
+        // New baseline. Both notifications are sent over the same connection, so subscribers receive them in this order
+        jetPeer->notifyState(path, change.jetState);
+        delta.changed = Json::Value(Json::objectValue);
+        delta.removed.clear();
+    }
+
+    delta.version++;
+    jetPeer->notifyState(path + JET_DELTA_STATE_SUFFIX, composeDeltaDocument(delta));
+}
+
+/**
+ * @brief Sends all pending notifications. Must be called on the event loop thread.
+ * 
+ */
+void JetPeerWrapper::flushJetStateNotifications()
+{
+    coalescingTimer.cancel();
+
+    for(const auto& path : pendingNotificationOrder)
+        sendJetStateNotification(path, pendingNotifications[path]);
+
+    pendingNotifications.clear();
+    pendingNotificationOrder.clear();
+}
+
+/**
+ * @brief Replaces the whole value of a cached Jet state and records which top-level members have changed or have been removed.
+ * jetStateCacheMutex has to be locked by the caller.
+ * 
+ * @param cachedJetState Local copy of the Jet state.
+ * @param newValue New value of the Jet state.
+ * @param change Change to which the new value and the changed and removed members are written.
+ */
+void JetPeerWrapper::replaceCachedJetState(Json::Value& cachedJetState, const Json::Value& newValue, JetStateChange& change)
+{
+    change.jetState = newValue;
+
+    // Jet states which are not objects (e.g. a single property) have no members to compare
+    if(newValue.isObject()) {
+        bool wasObject = cachedJetState.isObject();
+        if(wasObject) {
+            for(const auto& key : cachedJetState.getMemberNames()) {
+                if(!newValue.isMember(key))
+                    change.removedKeys.insert(key);
+            }
+        }
+        for(const auto& key : newValue.getMemberNames()) {
+            if(!wasObject || !cachedJetState.isMember(key) || cachedJetState[key] != newValue[key])
+                change.changedKeys.insert(key);
+        }
+    }
+
+    cachedJetState = newValue;
+}
+
+/**
+ * @brief Composes the document which is notified in the companion Jet state in delta mode.
+ * 
+ * @param delta Members changed since the last full notification of the Jet state.
+ * @return Json::Value object with "Version", "Changed" and "Removed" members.
+ */
+Json::Value JetPeerWrapper::composeDeltaDocument(const JetStateDelta& delta)
+{
+    Json::Value document;
+    document["Version"] = static_cast<Json::UInt64>(delta.version);
+    document["Changed"] = delta.changed;
+    document["Removed"] = Json::Value(Json::arrayValue);
+    for(const auto& key : delta.removed)
+        document["Removed"].append(key);
+    return document;
+}
+
+/**
+ * @brief Returns acknowledgement counters and round-trip latencies of all publications made by this peer.
+ * 
+ * @return JetPublicationStatistics structure.
+ */
+JetPublicationStatistics JetPeerWrapper::getPublicationStatistics()
+{
+    std::lock_guard<std::mutex> lock(publicationStatisticsMutex);
+    return publicationStatistics;
+}
+
+/**
+ * @brief Blocks until jetd has acknowledged all publications made so far, or until timeout expires.
+ * 
+ * @param timeout Maximum time to wait.
+ * @return true if all publications have been acknowledged.
+ * @return false if timeout has expired.
+ */
+bool JetPeerWrapper::waitForPublications(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(publicationStatisticsMutex);
+    return publicationsAcknowledged.wait_for(lock, timeout, [this]() { return publicationStatistics.pending == 0; });
+}
+
+/**
+ * @brief Blocks until the Jet event loop has executed all commands queued so far (notifications, removals, publications), or until timeout expires.
+ * Notifications held back by coalescing are only sent when their window expires, acknowledgements of publications are not awaited.
+ * 
+ * @param timeout Maximum time to wait.
+ * @return true if all commands queued before the call have been executed.
+ * @return false if timeout has expired.
+ */
+bool JetPeerWrapper::waitForQueuedCommands(std::chrono::milliseconds timeout)
+{
+    // Commands are executed in order, so a marker queued last is executed after all of them
+    auto marker = std::make_shared<std::promise<void>>();
+    std::future<void> executed = marker->get_future();
+    jetCommandQueue.push([marker]() {
+        marker->set_value();
+    });
+    return executed.wait_for(timeout) == std::future_status::ready;
+}
+
+/**
+ * @brief Blocks until the set executor has finished all submitted tasks, e.g. set requests and method calls for Jet states
+ * and methods which are being removed.
+ * 
+ */
+void JetPeerWrapper::waitForSetTasks()
+{
+    setExecutor.waitUntilIdle();
+}
+
+/**
+ * @brief Registers publications which are about to be queued, so that waiting for them accounts for not yet sent requests as well.
+ * 
+ * @param count Number of publications.
+ */
+void JetPeerWrapper::beginPublications(size_t count)
+{
+    std::lock_guard<std::mutex> lock(publicationStatisticsMutex);
+    publicationStatistics.pending += count;
+}
+
+/**
+ * @brief Unregisters publications which have been dropped before they were sent.
+ * 
+ * @param count Number of publications.
+ */
+void JetPeerWrapper::cancelPublications(size_t count)
+{
+    {
+        std::lock_guard<std::mutex> lock(publicationStatisticsMutex);
+        publicationStatistics.pending -= count;
+    }
+    publicationsAcknowledged.notify_all();
 }
 
 /**
- * @brief Callback function used in Jet state reader functions. It sets assign Json value to std::promise when called.
+ * @brief Creates a response callback which records the acknowledgement and round-trip latency of a publication.
+ * Must be called on the event loop thread right before the publication is sent.
  * 
- * @param promise Container which is assigned Json value containing Jet state(s).
- * @param value Json value containing Jet state(s).
+ * @param path Path of the published Jet state or method.
+ * @return hbk::jet::responseCallback_t callback which has to be passed to the publishing function of PeerAsync.
  */
-void JetPeerWrapper::readJetStateCb(std::promise<Json::Value>& promise, const Json::Value& value)
+hbk::jet::responseCallback_t JetPeerWrapper::trackPublication(const std::string& path)
 {
-    // value contains the data as an array of objects
-    Json::Value jetState = value[hbk::jsonrpc::RESULT];
-    promise.set_value(jetState);
+    auto sendTime = std::chrono::steady_clock::now();
+    return [this, path, sendTime](const Json::Value& response) {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sendTime);
+
+        // Response callbacks are called on the event loop thread, so the window can be refilled right away
+        publicationsInFlight--;
+        sendQueuedPublications();
+
+        bool failed = response.isMember(hbk::jsonrpc::ERR);
+        if(failed) {
+            std::string message = "Jet daemon rejected publication of \"" + path + "\": " + response[hbk::jsonrpc::ERR].toStyledString();
+            DAQLOG_E(jetModuleLogger, message.c_str());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(publicationStatisticsMutex);
+            if(failed)
+                publicationStatistics.failed++;
+            else
+                publicationStatistics.acknowledged++;
+            publicationStatistics.pending--;
+            publicationStatistics.totalLatency += latency;
+            publicationStatistics.maxLatency = std::max(publicationStatistics.maxLatency, latency);
+        }
+        publicationsAcknowledged.notify_all();
+    };
+}
 
-    // Stop the event loop
-    jetStateReadEventloop.stop();
+/**
+ * @brief Returns the local copy of a Jet state published by this peer.
+ * 
+ * @param path Path of the Jet state.
+ * @return Json::Value object containing the Jet state. Null Json value is returned if the Jet state has not been published by this peer.
+ */
+Json::Value JetPeerWrapper::getCachedJetState(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(jetStateCacheMutex);
+    auto it = jetStateCache.find(path);
+    if(it == jetStateCache.end())
+        return Json::Value();
+    return it->second;
 }
 
 /**
@@ -165,57 +1162,130 @@ void JetPeerWrapper::readJetStateCb(std::promise<Json::Value>& promise, const Js
  */
 void JetPeerWrapper::modifyJetState(const char* valueType, const std::string& path, const char* newValue)
 {
-    unsigned int port = hbk::jet::JETD_TCP_PORT;
-    std::string address("127.0.0.1");
-    hbk::jet::Peer peer(address, port);
-    // hbk::jet::PeerAsync peer(eventloop, address, port);
+    Json::Value value;
     if(strcmp(valueType, "bool") == 0) 
     {
         if(strcmp(newValue, "false") == 0)
         {
-            peer.setStateValue(path, false, 2.71828182846);
+            value = false;
         } 
         else if (strcmp(newValue, "true") == 0) 
         {
-            peer.setStateValue(path, true, 2.71828182846);
+            value = true;
         } 
         else 
         {
             std::string message = "Could not modify Jet state with path: " + path + "\n" + 
                 "invalid value for boolean expecting 'true'', or 'false'\n";
             DAQLOG_E(jetModuleLogger, message.c_str());
+            return;
         }
     } 
     else if(strcmp(valueType,"int")==0) 
     {
-        int value = atoi(newValue);
-        peer.setStateValue(path, value, 2.71828182846);
+        value = atoi(newValue);
     } 
     else if(strcmp(valueType, "double")==0) 
     {
-        double value = strtod(newValue, nullptr);
-        peer.setStateValue(path, value, 2.71828182846);
+        value = strtod(newValue, nullptr);
     } 
     else if(strcmp(valueType,"string")==0) 
     {
-        peer.setStateValue(path, newValue, 2.71828182846);
+        value = newValue;
     } 
     else if(strcmp(valueType,"json")==0) 
     {
-        Json::Value params;
-
         Json::CharReaderBuilder rBuilder;
-        if(rBuilder.newCharReader()->parse(newValue, newValue+strlen(newValue), &params, nullptr)) 
-        {
-            peer.setStateValue(path, params, 2.71828182846);
-        } 
-        else 
+        std::unique_ptr<Json::CharReader> reader(rBuilder.newCharReader());
+        if(!reader->parse(newValue, newValue+strlen(newValue), &value, nullptr)) 
         {
             std::string message = "Could not modify Jet state with path: " + path + "\n" + 
                 "error while parsing json!\n";
             DAQLOG_E(jetModuleLogger, message.c_str());
+            return;
         }
     }
+    else
+    {
+        return;
+    }
+
+    // Kept blocking, like the synchronous peer used to be
+    std::future<Json::Value> response = setJetState(path, value);
+    if(response.wait_for(std::chrono::seconds(JET_STATE_SET_TIMEOUT)) != std::future_status::ready) {
+        std::string message = "Timed out while modifying Jet state with path: " + path + "\n";
+        DAQLOG_E(jetModuleLogger, message.c_str());
+    }
+}
+
+/**
+ * @brief Requests jetd to set a Jet state to a new value. The request is sent over the long-lived TCP peer, so no connection is
+ * established per call. Typed values (bool, int, double, string) convert to Json::Value implicitly.
+ * 
+ * @param path Path of the Jet state.
+ * @param value Value which is requested to be set.
+ * @return std::future which is resolved with the response of jetd. The response contains "error" member if the set failed.
+ */
+std::future<Json::Value> JetPeerWrapper::setJetState(const std::string& path, const Json::Value& value)
+{
+    auto promise = std::make_shared<std::promise<Json::Value>>();
+    std::future<Json::Value> future = promise->get_future();
+
+    jetClientCommandQueue.push([this, path, value, promise]() {
+        jetClientPeer->setStateValueAsync(path, value, [path, promise](const Json::Value& response) {
+            if(response.isMember(hbk::jsonrpc::ERR)) {
+                std::string message = "Could not modify Jet state with path: " + path + "\n" + response[hbk::jsonrpc::ERR].toStyledString();
+                DAQLOG_E(jetModuleLogger, message.c_str());
+            }
+            promise->set_value(response);
+        }, JET_STATE_SET_TIMEOUT);
+    });
+
+    return future;
+}
+
+/**
+ * @brief Requests jetd to set multiple Jet states. All requests are issued in a single pass of the client event loop and are
+ * pipelined on the long-lived TCP peer, so a batch costs about one round trip instead of one per Jet state.
+ * 
+ * @param values Pairs of Jet state path and value which is requested to be set.
+ * @return std::future which is resolved with an array of jetd responses, in the same order as the requested values, once all of them arrived.
+ */
+std::future<Json::Value> JetPeerWrapper::setJetStates(const std::vector<std::pair<std::string, Json::Value>>& values)
+{
+    struct Batch
+    {
+        std::promise<Json::Value> promise;
+        Json::Value responses = Json::Value(Json::arrayValue);
+        size_t remaining;
+    };
+
+    auto batch = std::make_shared<Batch>();
+    std::future<Json::Value> future = batch->promise.get_future();
+    batch->remaining = values.size();
+    if(values.empty()) {
+        batch->promise.set_value(batch->responses);
+        return future;
+    }
+    batch->responses.resize(static_cast<Json::ArrayIndex>(values.size()));
+
+    jetClientCommandQueue.push([this, values, batch]() {
+        for(Json::ArrayIndex i = 0; i < values.size(); i++) {
+            const std::string& path = values[i].first;
+            // Response callbacks are called on the client event loop thread, one at a time
+            jetClientPeer->setStateValueAsync(path, values[i].second, [path, batch, i](const Json::Value& response) {
+                if(response.isMember(hbk::jsonrpc::ERR)) {
+                    std::string message = "Could not modify Jet state with path: " + path + "\n" + response[hbk::jsonrpc::ERR].toStyledString();
+                    DAQLOG_E(jetModuleLogger, message.c_str());
+                }
+                batch->responses[i] = response;
+                if(--batch->remaining == 0)
+                    batch->promise.set_value(batch->responses);
+            }, JET_STATE_SET_TIMEOUT);
+        }
+    });
+
+    return future;
 }
 
 /**
@@ -288,4 +1358,21 @@ void JetPeerWrapper::startJetEventloopThread()
     jetEventloopThread = std::thread{ &JetPeerWrapper::startJetEventloop, this };
 }
 
+void JetPeerWrapper::startJetClientEventloop()
+{
+    if(!jetClientEventloopRunning) {
+        jetClientEventloopRunning = true;
+        jetClientEventloopThread = std::thread{ [this]() { jetClientEventloop.execute(); } };
+    }
+}
+
+void JetPeerWrapper::stopJetClientEventloop()
+{
+    if(jetClientEventloopRunning) {
+        jetClientEventloopRunning = false;
+        jetClientEventloop.stop();
+        jetClientEventloopThread.join();
+    }
+}
+
 END_NAMESPACE_JET_MODULE
\ No newline at end of file
@@ -1,4 +1,8 @@
 #include "jet_server.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
 #include "jet_module_exceptions.h"
 
 BEGIN_NAMESPACE_JET_MODULE
@@ -8,22 +12,78 @@ BEGIN_NAMESPACE_JET_MODULE
  * as Jet states.
  * 
  * @param device A device which will be parsed and structure of which is published as Jet states.
+ * @param config Options which define how the device structure is published.
  */
-JetServer::JetServer(const InstancePtr& instance)
+JetServer::JetServer(const InstancePtr& instance, const JetServerConfig& config)
     : 
-    componentConverter(instance),
-    deviceConverter(instance),
-    functionBlockConverter(instance),
-    channelConverter(instance),
-    signalConverter(instance),
-    inputPortConverter(instance)
+    config(config),
+    componentIndex(instance),
+    opendaqEventQueue(config.asyncOpendaqEvents),
+    componentConverter(instance, this->config, componentIndex, opendaqEventQueue),
+    deviceConverter(instance, this->config, componentIndex, opendaqEventQueue),
+    functionBlockConverter(instance, this->config, componentIndex, opendaqEventQueue),
+    channelConverter(instance, this->config, componentIndex, opendaqEventQueue),
+    signalConverter(instance, this->config, componentIndex, opendaqEventQueue),
+    inputPortConverter(instance, this->config, componentIndex, opendaqEventQueue),
+    publishFilter(this->config.publishFilter),
+    evictionRunning(false),
+    snapshotFileRecords(0),
+    snapshotFileValid(false)
 {
     this->opendaqInstance = instance;
     this->rootDevice = instance.getRootDevice();
+
+    // Core events of the whole instance are needed to keep track of removed components
+    opendaqInstance.getContext().getOnCoreEvent() += event(this, &JetServer::onCoreEvent);
+
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+    jetPeerWrapper.setNotificationCoalescing(config.notificationCoalescingWindow, config.notificationCoalescingMaxPending);
+    jetPeerWrapper.setDeltaNotifications(config.deltaNotifications, config.deltaBaselineThreshold);
+    jetPeerWrapper.setMaxPublicationsInFlight(config.maxPublicationsInFlight);
+    jetPeerWrapper.configureSetExecutor(config.setWorkerThreads, config.priorityWorkerThreads, config.setQueueCapacity, config.setOverflowPolicy);
+    jetPeerWrapper.setSynchronousSets(config.synchronousSetTimeout);
+    jetPeerWrapper.setMethodCallTimeout(config.methodCallTimeout);
+
+    if(config.lazyPublication && config.lazyEvictionTimeout.count() > 0) {
+        evictionRunning = true;
+        evictionThread = std::thread(&JetServer::runEviction, this);
+    }
 }
 
 JetServer::~JetServer()
 {
+    if(reconcileThread.joinable())
+        reconcileThread.join();
+    // Values changed since publishing are stored as well
+    writeSnapshot();
+
+    opendaqInstance.getContext().getOnCoreEvent() -= event(this, &JetServer::onCoreEvent);
+    // Handlers of the components refer to the converters and the queue. Once they are detached no more events are dispatched,
+    // so the queued ones are the last which refer to the converters.
+    componentIndex.removeSubscriptions();
+    opendaqEventQueue.stop();
+
+    if(evictionThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(expansionMutex);
+            evictionRunning = false;
+        }
+        evictionCondition.notify_all();
+        evictionThread.join();
+    }
+
+    // Callbacks of all Jet states and methods refer to this JetServer, so they can't outlive it. All of them are published
+    // under the root device, including "_index", "_expand" and "_delta" companions.
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+    std::string rootPath = toStdString(rootDevice.getGlobalId());
+    jetPeerWrapper.removeJetStates(rootPath);
+
+    // Once jetd doesn't route requests anymore, the requests which have already been handed to the set executor are waited for
+    if(!jetPeerWrapper.waitForQueuedCommands(config.methodCallTimeout)) {
+        std::string message = "Jet states under \"" + rootPath + "\" have not been removed in time.\n";
+        DAQLOG_W(jetModuleLogger, message.c_str());
+    }
+    jetPeerWrapper.waitForSetTasks();
 }
 
 /**
@@ -32,50 +92,119 @@ JetServer::~JetServer()
  */
 void JetServer::publishJetStates()
 {
-    // Have to parse root device separately because parsing in parseOpendaqInstance function is done relative to it
-    deviceConverter.composeJetState(rootDevice);
-    parseOpendaqInstance(opendaqInstance);
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+    JetPublicationStatistics statisticsBefore = jetPeerWrapper.getPublicationStatistics();
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Previous reconciliation would publish into the cleared index
+    if(reconcileThread.joinable())
+        reconcileThread.join();
+    componentIndex.clear();
+    snapshotEntries.clear();
+
+    if(config.lazyPublication) {
+        {
+            std::lock_guard<std::mutex> lock(expansionMutex);
+            expandedComponents.clear();
+        }
+        publishIndexStates();
+        publishExpandMethod();
+    }
+    else if(publishSnapshot()) {
+        // Jet states are composed from the openDAQ tree in the background and the snapshot is corrected afterwards
+        reconcileThread = std::thread(&JetServer::reconcileSnapshot, this);
+    }
+    else {
+        // Have to parse root device separately because parsing in parseOpendaqInstance function is done relative to it
+        deviceConverter.composeJetState(rootDevice);
+        parseOpendaqInstance(opendaqInstance);
+        writeSnapshot();
+    }
+
+    if(config.publicationTimeout.count() == 0)
+        return;
+
+    // Jet states are published asynchronously, the tree is fully live once jetd has acknowledged all of them
+    bool isLive = jetPeerWrapper.waitForPublications(config.publicationTimeout);
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    JetPublicationStatistics statistics = jetPeerWrapper.getPublicationStatistics();
+
+    size_t acknowledged = statistics.acknowledged - statisticsBefore.acknowledged;
+    size_t failed = statistics.failed - statisticsBefore.failed;
+    size_t completed = acknowledged + failed;
+    auto averageLatency = (completed == 0) ? std::chrono::microseconds(0) : (statistics.totalLatency - statisticsBefore.totalLatency) / completed;
+
+    double throughput = (duration.count() == 0) ? 0.0 : completed * 1000.0 / duration.count();
+
+    std::string message = std::to_string(acknowledged) + " Jet states and methods published (" + std::to_string(failed) + " failed) in "
+        + std::to_string(duration.count()) + " ms (" + std::to_string(static_cast<int64_t>(throughput)) + " per second), average acknowledgement latency "
+        + std::to_string(averageLatency.count()) + " us.";
+    if(isLive) {
+        DAQLOG_I(jetModuleLogger, message.c_str());
+    }
+    else {
+        message = "Timed out while waiting for jetd to acknowledge publications. " + std::to_string(statistics.pending) + " still pending, " + message;
+        DAQLOG_W(jetModuleLogger, message.c_str());
+    }
+}
+
+/**
+ * @brief Waits until the core events raised by openDAQ so far have been turned into Jet state updates and these updates
+ * have been handed to jetd by the Jet event loop.
+ * 
+ * @param timeout Maximum time to wait for each of the two stages.
+ * @return true if all events have been processed and sent, false if the timeout expired first.
+ */
+bool JetServer::waitForOpendaqEvents(std::chrono::milliseconds timeout)
+{
+    if(!opendaqEventQueue.waitUntilIdle(timeout))
+        return false;
+    return JetPeerWrapper::getInstance().waitForQueuedCommands(timeout);
 }
 
 /**
  * @brief Parses a openDAQ folder to identify components in it. The components are parsed themselves to create their Jet states.
+ * Components are composed by several threads, while their Jet states are published in the order in which the tree is traversed.
  * 
  * @param parentFolder A folder which is parsed to identify components in it.
  */
 void JetServer::parseOpendaqInstance(const FolderPtr& parentFolder)
+{
+    std::vector<ComponentPtr> components;
+    collectComponents(parentFolder, components);
+    composeJetStates(components);
+}
+
+/**
+ * @brief Recursively collects components of a openDAQ folder whose Jet states have to be published, in depth-first order.
+ * 
+ * @param parentFolder A folder which is parsed to identify components in it.
+ * @param components Vector to which the components are appended.
+ */
+void JetServer::collectComponents(const FolderPtr& parentFolder, std::vector<ComponentPtr>& components)
 {
     auto items = parentFolder.getItems(search::Any());
     for(const auto& item : items)
     {
         auto folder = item.asPtrOrNull<IFolder>();
         auto component = item.asPtrOrNull<IComponent>();
-        auto device = item.asPtrOrNull<IDevice>();
-        auto functionBlock = item.asPtrOrNull<IFunctionBlock>();
-        auto channel = item.asPtrOrNull<IChannel>();
-        auto signal = item.asPtrOrNull<ISignal>();
-        auto inputPort = item.asPtrOrNull<IInputPort>();
-
-        if(device.assigned()) {
-            deviceConverter.composeJetState(device);
-        }
-        else if(channel.assigned()) {
-            channelConverter.composeJetState(channel);
-        }
-        else if(functionBlock.assigned()) {
-            functionBlockConverter.composeJetState(functionBlock);
-        }
-        else if(signal.assigned()) {
-            signalConverter.composeJetState(signal);
-        }
-        else if(inputPort.assigned()) {
-            inputPortConverter.composeJetState(inputPort);
+
+        // Excluded subtree is skipped as a whole, none of its properties is read
+        if(component.assigned() && publishFilter.prunes(component))
+            continue;
+
+        if(item.supportsInterface<IDevice>() || item.supportsInterface<IFunctionBlock>() || item.supportsInterface<ISignal>()
+            || item.supportsInterface<IInputPort>()) {
+            if(publishFilter.includes(component))
+                components.push_back(component);
         }
         else if(folder.assigned()) { // It is important to test for folder last as everything besides component is a folder as well
             // We do nothing here because we want to identify pure components (not its descendants)
             // Recursion is done in separate if statement
         }
         else if(component.assigned()) { // It is important to test for component after folder!
-            componentConverter.composeJetState(component);
+            if(publishFilter.includes(component))
+                components.push_back(component);
         }
         else {
             std::string message = "Unhandled item \"" + item.getName() + "\" in openDAQ instance!";
@@ -83,9 +212,502 @@ void JetServer::parseOpendaqInstance(const FolderPtr& parentFolder)
         }
 
         if(folder.assigned()) {
-            parseOpendaqInstance(folder);
+            collectComponents(folder, components);
+        }
+    }
+}
+
+/**
+ * @brief Composes and publishes Jet states of components. Work is spread over JetServerConfig::compositionThreads threads, each of them
+ * picking the next component which hasn't been composed yet. Publications of every component are captured and released in the order
+ * of the components, so the result doesn't depend on the number of threads.
+ * 
+ * @param components Components whose Jet states are published.
+ */
+void JetServer::composeJetStates(const std::vector<ComponentPtr>& components)
+{
+    size_t threadCount = std::min(config.compositionThreads, components.size());
+    if(threadCount <= 1) {
+        for(const auto& component : components)
+            composeJetState(component);
+        return;
+    }
+
+    std::vector<std::unique_ptr<JetPublicationCapture>> captures(components.size());
+    std::vector<std::exception_ptr> errors(components.size());
+    std::atomic<size_t> next(0);
+    // Publications are released to the capture of the calling thread if there is one (e.g. while reconciling a snapshot)
+    JetPublicationCapture* parent = JetPublicationCapture::getActive();
+
+    auto compose = [this, &components, &captures, &errors, &next, parent]() {
+        for(size_t i = next++; i < components.size(); i = next++) {
+            captures[i] = std::make_unique<JetPublicationCapture>(parent);
+            try {
+                composeJetState(components[i]);
+            }
+            catch(...) {
+                errors[i] = std::current_exception();
+            }
+            captures[i]->end();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < threadCount; i++)
+        threads.emplace_back(compose);
+    compose();
+    for(auto& thread : threads)
+        thread.join();
+
+    for(size_t i = 0; i < components.size(); i++) {
+        captures[i]->release();
+        if(errors[i])
+            std::rethrow_exception(errors[i]);
+    }
+}
+
+/**
+ * @brief Composes and publishes Jet state of a single component with the converter matching its type.
+ * 
+ * @param component Component whose Jet state is published.
+ */
+void JetServer::composeJetState(const ComponentPtr& component)
+{
+    auto device = component.asPtrOrNull<IDevice>();
+    auto functionBlock = component.asPtrOrNull<IFunctionBlock>();
+    auto channel = component.asPtrOrNull<IChannel>();
+    auto signal = component.asPtrOrNull<ISignal>();
+    auto inputPort = component.asPtrOrNull<IInputPort>();
+
+    if(device.assigned()) {
+        deviceConverter.composeJetState(device);
+    }
+    else if(channel.assigned()) {
+        channelConverter.composeJetState(channel);
+    }
+    else if(functionBlock.assigned()) {
+        functionBlockConverter.composeJetState(functionBlock);
+    }
+    else if(signal.assigned()) {
+        signalConverter.composeJetState(signal);
+    }
+    else if(inputPort.assigned()) {
+        inputPortConverter.composeJetState(inputPort);
+    }
+    else {
+        componentConverter.composeJetState(component);
+    }
+}
+
+/**
+ * @brief Handles core events of the openDAQ instance which concern the whole published tree rather than a single component.
+ * Jet states of added components are composed and published, Jet states of removed components are removed together with their descendants.
+ * Events are handled on the publisher thread of the OpendaqEventQueue, in the order in which they were raised.
+ * 
+ * @param sender Component which triggered the event.
+ * @param args Arguments of the core event.
+ */
+void JetServer::onCoreEvent(ComponentPtr& sender, CoreEventArgsPtr& args)
+{
+    CoreEventId eventId = CoreEventId(args.getEventId());
+    if(eventId == CoreEventId::ComponentAdded) {
+        ComponentPtr component = args.getParameters().get("Component");
+        opendaqEventQueue.dispatch([this, component]() { publishSubtree(component); });
+    }
+    else if(eventId == CoreEventId::ComponentRemoved) {
+        // Sender is the folder from which the component has been removed, "Id" holds the local ID of the removed component
+        StringPtr localId = args.getParameters().get("Id");
+        std::string globalId = toStdString(sender.getGlobalId()) + "/" + toStdString(localId);
+        opendaqEventQueue.dispatch([this, globalId]() { unpublishSubtree(globalId); });
+    }
+}
+
+/**
+ * @brief Publishes Jet states of a component added to the openDAQ tree and of all of its descendants.
+ * 
+ * @param component Added component.
+ */
+void JetServer::publishSubtree(const ComponentPtr& component)
+{
+    if(publishFilter.prunesAncestorOf(component))
+        return;
+
+    // Added components are only listed, their Jet states are composed when they are expanded
+    if(config.lazyPublication) {
+        publishIndexStates();
+        return;
+    }
+
+    std::vector<ComponentPtr> components;
+    if(hasOwnJetState(component) && publishFilter.includes(component))
+        components.push_back(component);
+    auto folder = component.asPtrOrNull<IFolder>();
+    if(folder.assigned())
+        collectComponents(folder, components);
+
+    std::string message = "Publishing " + std::to_string(components.size()) + " Jet states of added component \"" + toStdString(component.getGlobalId()) + "\"\n";
+    DAQLOG_I(jetModuleLogger, message.c_str());
+    composeJetStates(components);
+}
+
+/**
+ * @brief Removes Jet states of a component removed from the openDAQ tree and of all of its descendants.
+ * 
+ * @param globalId Global ID of the removed component.
+ */
+void JetServer::unpublishSubtree(const std::string& globalId)
+{
+    componentIndex.removeComponent(globalId);
+    JetPeerWrapper::getInstance().removeJetStates(globalId);
+
+    if(config.lazyPublication) {
+        {
+            std::lock_guard<std::mutex> lock(expansionMutex);
+            std::string prefix = globalId + "/";
+            for(auto it = expandedComponents.begin(); it != expandedComponents.end();) {
+                if(it->first == globalId || it->first.compare(0, prefix.size(), prefix) == 0)
+                    it = expandedComponents.erase(it);
+                else
+                    ++it;
+            }
         }
+        publishIndexStates();
     }
+
+    std::string message = "Removed Jet states of component \"" + globalId + "\"\n";
+    DAQLOG_I(jetModuleLogger, message.c_str());
+}
+
+/**
+ * @brief Checks whether a component is published as a Jet state of its own. Pure folders (e.g. "FB" or "Sig") are not, only their content is.
+ * 
+ * @param component Checked component.
+ * @return true if the component has a Jet state.
+ */
+bool JetServer::hasOwnJetState(const ComponentPtr& component)
+{
+    return !component.supportsInterface<IFolder>() || component.supportsInterface<IDevice>() || component.supportsInterface<IFunctionBlock>()
+        || component.supportsInterface<ISignal>() || component.supportsInterface<IInputPort>();
+}
+
+/**
+ * @brief Publishes a Jet state "<deviceGlobalId>/_index" for every device of the openDAQ tree. It lists global IDs of the components
+ * owned by the device (including its sub-devices, which have an index of their own). Index of a device which no longer exists is removed.
+ * 
+ */
+void JetServer::publishIndexStates()
+{
+    std::vector<ComponentPtr> components;
+    collectComponents(opendaqInstance, components);
+
+    // Every component is listed in the index of its closest device
+    std::map<std::string, Json::Value> indexes;
+    indexes[toStdString(rootDevice.getGlobalId())]["Components"] = Json::Value(Json::arrayValue);
+    for(const auto& component : components) {
+        if(component.supportsInterface<IDevice>())
+            indexes[toStdString(component.getGlobalId())]["Components"] = Json::Value(Json::arrayValue);
+
+        ComponentPtr parent = component.getParent();
+        while(parent.assigned() && !parent.supportsInterface<IDevice>())
+            parent = parent.getParent();
+        if(parent.assigned())
+            indexes[toStdString(parent.getGlobalId())]["Components"].append(toStdString(component.getGlobalId()));
+    }
+
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+    std::lock_guard<std::mutex> lock(expansionMutex);
+    std::set<std::string> publishedPaths;
+    for(const auto& deviceAndIndex : indexes) {
+        std::string path = deviceAndIndex.first + JET_INDEX_STATE_SUFFIX;
+        if(indexStatePaths.count(path) > 0)
+            jetPeerWrapper.updateJetState(path, deviceAndIndex.second);
+        else
+            jetPeerWrapper.publishJetState(path, deviceAndIndex.second, nullptr);
+        publishedPaths.insert(path);
+    }
+    for(const auto& path : indexStatePaths) {
+        if(publishedPaths.count(path) == 0)
+            jetPeerWrapper.removeJetStates(path, false);
+    }
+    indexStatePaths.swap(publishedPaths);
+}
+
+/**
+ * @brief Publishes the Jet method "<rootDeviceGlobalId>/_expand". It takes a global ID (as a string or a single element array),
+ * composes and publishes the Jet state of that component if it isn't published yet and returns the Jet state.
+ * 
+ */
+void JetServer::publishExpandMethod()
+{
+    std::string path = toStdString(rootDevice.getGlobalId()) + JET_EXPAND_METHOD_SUFFIX;
+    JetMethodCallback cb = [this](const Json::Value& args) -> Json::Value
+    {
+        Json::Value componentPath = (args.isArray() && args.size() == 1) ? args[0] : args;
+        if(!componentPath.isString())
+            return jetModuleExceptionToString(JetModuleException::JM_FUNCTION_INCOMPATIBLE_ARGUMENT_TYPES);
+        return expandJetState(componentPath.asString());
+    };
+
+    JetPeerWrapper::getInstance().publishJetMethod(path, cb);
+}
+
+/**
+ * @brief Composes and publishes the Jet state of a component on demand. Component which is already expanded is only marked as accessed.
+ * 
+ * @param path Global ID of the component.
+ * @return Json::Value holding the Jet state of the component, or an error message if there is no such component.
+ */
+Json::Value JetServer::expandJetState(const std::string& path)
+{
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+
+    ComponentPtr component;
+    if(path == toStdString(rootDevice.getGlobalId()))
+        component = rootDevice;
+    else
+        component = opendaqInstance.findComponent(jetPeerWrapper.removeRootDeviceId(path));
+    if(!component.assigned() || !hasOwnJetState(component))
+        return "Could not find component with path: " + path;
+    if(path != toStdString(rootDevice.getGlobalId()) && (publishFilter.prunesAncestorOf(component) || !publishFilter.includes(component)))
+        return "Component with path: " + path + " is excluded from publishing";
+
+    std::lock_guard<std::mutex> lock(expansionMutex);
+    auto it = expandedComponents.find(path);
+    if(it == expandedComponents.end()) {
+        // Paths of everything the component publishes (ObjectProperties, methods...) are needed to remove it again
+        JetPublicationCapture capture;
+        composeJetState(component);
+        capture.end();
+        it = expandedComponents.emplace(path, LazyExpansion()).first;
+        it->second.paths = capture.getPaths();
+        capture.release();
+
+        std::string message = "Expanded Jet state \"" + path + "\"\n";
+        DAQLOG_I(jetModuleLogger, message.c_str());
+    }
+    it->second.lastAccess = std::chrono::steady_clock::now();
+
+    return jetPeerWrapper.getCachedJetState(path);
+}
+
+/**
+ * @brief Removes Jet states of components which haven't been expanded for JetServerConfig::lazyEvictionTimeout.
+ * Mutex has to be locked by the caller.
+ * 
+ */
+void JetServer::evictIdleJetStates()
+{
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+    auto now = std::chrono::steady_clock::now();
+
+    for(auto it = expandedComponents.begin(); it != expandedComponents.end();) {
+        if(now - it->second.lastAccess < config.lazyEvictionTimeout) {
+            ++it;
+            continue;
+        }
+
+        // Only the component's own Jet states are removed, expanded children are evicted on their own
+        for(const auto& path : it->second.paths) {
+            componentIndex.removeEntry(path);
+            jetPeerWrapper.removeJetStates(path, false);
+        }
+        std::string message = "Evicted idle Jet state \"" + it->first + "\"\n";
+        DAQLOG_I(jetModuleLogger, message.c_str());
+        it = expandedComponents.erase(it);
+    }
+}
+
+void JetServer::runEviction()
+{
+    auto period = std::max(config.lazyEvictionTimeout / 4, std::chrono::milliseconds(10));
+
+    std::unique_lock<std::mutex> lock(expansionMutex);
+    while(evictionRunning) {
+        evictionCondition.wait_for(lock, period, [this]() { return !evictionRunning; });
+        if(evictionRunning)
+            evictIdleJetStates();
+    }
+}
+
+/**
+ * @brief Publishes Jet states stored in the snapshot file (JetServerConfig::snapshotFile), without reading anything from openDAQ.
+ * 
+ * @return true if the snapshot has been published, false if snapshots are disabled or there is no usable snapshot.
+ */
+bool JetServer::publishSnapshot()
+{
+    if(config.snapshotFile.empty())
+        return false;
+
+    std::vector<JetSnapshotEntry> entries;
+    size_t records;
+    if(!JetSnapshot::load(config.snapshotFile, toStdString(rootDevice.getGlobalId()), entries, records)) {
+        // File is written anew from the composed Jet states
+        snapshotFileValid = false;
+        return false;
+    }
+    snapshotFileVersions.clear();
+    for(const auto& entry : entries)
+        snapshotFileVersions[entry.path] = entry.version;
+    snapshotFileRecords = records;
+    snapshotFileValid = true;
+
+    // Callbacks resolve their targets in the openDAQ tree, so Jet clients can change values before the tree is reconciled
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+    JetStateCallback componentCallback = componentConverter.createJetCallback();
+    JetStateCallback objectPropertyCallback = componentConverter.createObjectPropertyJetCallback();
+    JetStateCallback propertyCallback = componentConverter.createPropertyJetCallback();
+    for(const auto& entry : entries) {
+        JetStateCallback callback = componentCallback;
+        if(entry.kind == JetSnapshotStateKind::ObjectProperty)
+            callback = objectPropertyCallback;
+        else if(entry.kind == JetSnapshotStateKind::Property)
+            callback = propertyCallback;
+        jetPeerWrapper.publishJetState(entry.path, entry.value, callback, entry.lane);
+    }
+
+    snapshotEntries.swap(entries);
+    std::string message = std::to_string(snapshotEntries.size()) + " Jet states published from snapshot \"" + config.snapshotFile + "\"\n";
+    DAQLOG_I(jetModuleLogger, message.c_str());
+    return true;
+}
+
+/**
+ * @brief Composes Jet states from the openDAQ tree after the snapshot has been published. Jet states which are already published
+ * are only notified if their value differs from the snapshot, Jet states of components which no longer exist are removed and new ones
+ * are published. Snapshot file is updated afterwards.
+ * 
+ */
+void JetServer::reconcileSnapshot()
+{
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::set<std::string> snapshotPaths;
+    for(const auto& entry : snapshotEntries)
+        snapshotPaths.insert(entry.path);
+
+    JetPublicationCapture capture;
+    bool composed = false;
+    try {
+        deviceConverter.composeJetState(rootDevice);
+        parseOpendaqInstance(opendaqInstance);
+        composed = true;
+    }
+    catch(const std::exception& e) {
+        std::string message = "Failed to reconcile snapshot with openDAQ: " + std::string(e.what()) + "\n";
+        DAQLOG_E(jetModuleLogger, message.c_str());
+    }
+    catch(...) {
+        std::string message = "Failed to reconcile snapshot with openDAQ with an unknown exception.\n";
+        DAQLOG_E(jetModuleLogger, message.c_str());
+    }
+    capture.end();
+
+    // Composing has replaced the cached values without notifying them
+    capture.discard(snapshotPaths);
+    std::set<std::string> composedPaths(capture.getPaths().begin(), capture.getPaths().end());
+    capture.release();
+
+    size_t changed = 0;
+    size_t removed = 0;
+    for(const auto& entry : snapshotEntries) {
+        if(composedPaths.count(entry.path) == 0) {
+            // Incomplete composition does not prove that a component is gone, so its snapshot state is kept
+            if(composed) {
+                jetPeerWrapper.removeJetStates(entry.path, false);
+                removed++;
+            }
+        }
+        else if(JetSnapshot::computeVersion(jetPeerWrapper.getCachedJetState(entry.path)) != entry.version) {
+            jetPeerWrapper.refreshJetState(entry.path);
+            changed++;
+        }
+    }
+    // Snapshot is only updated from a complete tree, entries are kept so that writeSnapshot leaves the file untouched
+    if(!composed)
+        return;
+    snapshotEntries.clear();
+    writeSnapshot();
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    std::string message = "Snapshot reconciled with openDAQ in " + std::to_string(duration.count()) + " ms, " + std::to_string(changed)
+        + " Jet states changed, " + std::to_string(removed) + " removed.\n";
+    DAQLOG_I(jetModuleLogger, message.c_str());
+}
+
+/**
+ * @brief Stores the currently published Jet states of components and their properties in the snapshot file. Only the Jet states
+ * which differ from the file are appended to it, together with records of the removed ones. File is written anew if it hasn't been
+ * read or written by this JetServer, or once outdated records outnumber the current ones.
+ * 
+ */
+void JetServer::writeSnapshot()
+{
+    if(config.snapshotFile.empty() || config.lazyPublication || !snapshotEntries.empty())
+        return;
+
+    JetPeerWrapper& jetPeerWrapper = JetPeerWrapper::getInstance();
+    std::vector<JetSnapshotEntry> entries;
+    for(const auto& pathAndEntry : componentIndex.getEntries()) {
+        JetSnapshotEntry entry;
+        entry.path = pathAndEntry.first;
+        entry.value = jetPeerWrapper.getCachedJetState(entry.path);
+        if(entry.value.isNull())
+            continue; // Resolved from Jet, but not published by this JetServer
+
+        const ComponentIndexEntry& target = pathAndEntry.second;
+        if(target.propertyName.empty()) {
+            entry.kind = JetSnapshotStateKind::Component;
+            entry.lane = entry.path;
+        }
+        else {
+            if(!target.component.hasProperty(target.propertyName))
+                continue;
+            bool isObject = target.component.getProperty(target.propertyName).getValueType() == CoreType::ctObject;
+            entry.kind = isObject ? JetSnapshotStateKind::ObjectProperty : JetSnapshotStateKind::Property;
+            entry.lane = toStdString(target.component.getGlobalId());
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    // Same tree always produces the same file
+    std::sort(entries.begin(), entries.end(), [](const JetSnapshotEntry& a, const JetSnapshotEntry& b) { return a.path < b.path; });
+
+    std::map<std::string, uint64_t> versions;
+    std::vector<JetSnapshotEntry> changedEntries;
+    std::vector<std::string> removedPaths;
+    for(const auto& entry : entries) {
+        uint64_t version = JetSnapshot::computeVersion(entry.value);
+        versions[entry.path] = version;
+        auto it = snapshotFileVersions.find(entry.path);
+        if(it == snapshotFileVersions.end() || it->second != version)
+            changedEntries.push_back(entry);
+    }
+    for(const auto& pathAndVersion : snapshotFileVersions) {
+        if(versions.count(pathAndVersion.first) == 0)
+            removedPaths.push_back(pathAndVersion.first);
+    }
+
+    size_t records = snapshotFileRecords + changedEntries.size() + removedPaths.size();
+    bool written;
+    if(!snapshotFileValid || records > JET_SNAPSHOT_COMPACTION_RATIO * std::max<size_t>(entries.size(), 1)) {
+        written = JetSnapshot::write(config.snapshotFile, toStdString(rootDevice.getGlobalId()), entries);
+        records = entries.size();
+    }
+    else if(changedEntries.empty() && removedPaths.empty()) {
+        return;
+    }
+    else {
+        written = JetSnapshot::append(config.snapshotFile, changedEntries, removedPaths);
+    }
+
+    // File which could not be updated is written anew next time
+    snapshotFileValid = written;
+    if(!written)
+        return;
+    snapshotFileVersions.swap(versions);
+    snapshotFileRecords = records;
 }
 
 END_NAMESPACE_JET_MODULE
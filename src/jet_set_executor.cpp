@@ -0,0 +1,244 @@
+#include "jet_set_executor.h"
+#include <algorithm>
+#include <exception>
+#include <string>
+#include "jet_module_exceptions.h"
+
+BEGIN_NAMESPACE_JET_MODULE
+
+JetSetExecutor::JetSetExecutor()
+    : queued(0)
+    , queuedLowPriority(0)
+    , running(false)
+    , queueCapacity(0)
+    , overflowPolicy(JetSetOverflowPolicy::Reject)
+{
+    configure(JET_SET_EXECUTOR_DEFAULT_THREADS, JET_SET_EXECUTOR_DEFAULT_PRIORITY_THREADS, JET_SET_EXECUTOR_DEFAULT_QUEUE_CAPACITY,
+              JetSetOverflowPolicy::Reject);
+}
+
+JetSetExecutor::~JetSetExecutor()
+{
+    stop();
+}
+
+/**
+ * @brief (Re)starts the executor with new limits. Tasks which are already queued are finished by the old workers first.
+ * 
+ * @param threadCount Number of worker threads executing tasks of any priority. At least one thread is started.
+ * @param priorityThreadCount Number of additional worker threads which only execute high-priority tasks.
+ * @param queueCapacity Maximum number of low-priority tasks waiting for a worker. Zero means unlimited.
+ * @param overflowPolicy What happens to a low-priority task submitted while the queue is full.
+ */
+void JetSetExecutor::configure(size_t threadCount, size_t priorityThreadCount, size_t queueCapacity, JetSetOverflowPolicy overflowPolicy)
+{
+    stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    this->queueCapacity = queueCapacity;
+    this->overflowPolicy = overflowPolicy;
+    statistics = JetSetExecutorStatistics();
+    statistics.queueCapacity = queueCapacity;
+    start(std::max<size_t>(threadCount, 1), priorityThreadCount);
+}
+
+/**
+ * @brief Queues a task for execution on one of the worker threads. Task starts only after the previously submitted tasks of the same
+ * lane have finished.
+ * 
+ * @param lane Key of the lane to which the task belongs.
+ * @param task Task to be executed.
+ * @param priority Priority of the task. A high-priority task also speeds up the tasks queued before it in the same lane.
+ * @return true if the task was queued, false if it was rejected because the queue is full or the executor is stopped.
+ */
+bool JetSetExecutor::submit(const std::string& lane, Task task, JetSetPriority priority)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    bool highPriority = (priority == JetSetPriority::High);
+    auto isFull = [this, highPriority]() { return !highPriority && queueCapacity != 0 && queuedLowPriority >= queueCapacity; };
+
+    if(overflowPolicy == JetSetOverflowPolicy::Block)
+        slotAvailable.wait(lock, [this, &isFull]() { return !running || !isFull(); });
+
+    if(!running || isFull()) {
+        statistics.rejected++;
+        return false;
+    }
+
+    Lane& taskLane = lanes[lane];
+    taskLane.tasks.push_back({std::move(task), priority, std::chrono::steady_clock::now()});
+    queued++;
+    if(highPriority)
+        taskLane.highPriorityTasks++;
+    else
+        queuedLowPriority++;
+    statistics.queued = queued;
+    statistics.peakQueued = std::max(statistics.peakQueued, queued);
+    statistics.lanes = lanes.size();
+
+    if(!taskLane.scheduled) {
+        scheduleLane(lane, taskLane);
+    }
+    else if(highPriority && !taskLane.running) {
+        // Lane waits in the low-priority queue, it is moved so that the new task doesn't wait behind other lanes
+        auto it = std::find(readyLanes.begin(), readyLanes.end(), lane);
+        if(it != readyLanes.end()) {
+            readyLanes.erase(it);
+            readyHighPriorityLanes.push_back(lane);
+            taskAvailable.notify_all();
+        }
+    }
+    // Busy lane is rescheduled by the worker running its current task
+    return true;
+}
+
+/**
+ * @brief Returns a snapshot of the executor counters.
+ * 
+ * @return JetSetExecutorStatistics object.
+ */
+JetSetExecutorStatistics JetSetExecutor::getStatistics()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+/**
+ * @brief Blocks until all submitted tasks have been executed, including the tasks submitted while waiting.
+ * 
+ */
+void JetSetExecutor::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return lanes.empty(); });
+}
+
+/**
+ * @brief Puts a lane with queued tasks into the ready queue matching its priority. Mutex has to be locked by the caller.
+ * 
+ * @param key Key of the lane.
+ * @param lane The lane.
+ */
+void JetSetExecutor::scheduleLane(const std::string& key, Lane& lane)
+{
+    lane.scheduled = true;
+    if(lane.highPriorityTasks > 0)
+        readyHighPriorityLanes.push_back(key);
+    else
+        readyLanes.push_back(key);
+    // Workers reserved for high-priority tasks wait on the same condition, so all of them are woken up
+    taskAvailable.notify_all();
+}
+
+bool JetSetExecutor::hasReadyLane(bool priorityOnly)
+{
+    return !readyHighPriorityLanes.empty() || (!priorityOnly && !readyLanes.empty());
+}
+
+/**
+ * @brief Starts worker threads. Mutex has to be locked by the caller.
+ * 
+ * @param threadCount Number of worker threads executing tasks of any priority.
+ * @param priorityThreadCount Number of worker threads which only execute high-priority tasks.
+ */
+void JetSetExecutor::start(size_t threadCount, size_t priorityThreadCount)
+{
+    running = true;
+    statistics.threads = threadCount + priorityThreadCount;
+    statistics.priorityThreads = priorityThreadCount;
+    for(size_t i = 0; i < threadCount; i++)
+        workers.emplace_back(&JetSetExecutor::runWorker, this, false);
+    for(size_t i = 0; i < priorityThreadCount; i++)
+        workers.emplace_back(&JetSetExecutor::runWorker, this, true);
+}
+
+/**
+ * @brief Stops worker threads after all queued tasks have been executed.
+ * 
+ */
+void JetSetExecutor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    taskAvailable.notify_all();
+    slotAvailable.notify_all();
+
+    for(auto& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+void JetSetExecutor::runWorker(bool priorityOnly)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+        taskAvailable.wait(lock, [this, priorityOnly]() { return !running || hasReadyLane(priorityOnly); });
+        if(!hasReadyLane(priorityOnly)) {
+            // Stopped. Lanes which are still running are rescheduled by their workers, so wait for them before leaving
+            if(queued == 0 || priorityOnly)
+                return;
+            taskAvailable.wait(lock, [this]() { return hasReadyLane(false) || queued == 0; });
+            continue;
+        }
+
+        std::deque<std::string>& readyQueue = readyHighPriorityLanes.empty() ? readyLanes : readyHighPriorityLanes;
+        std::string laneKey = std::move(readyQueue.front());
+        readyQueue.pop_front();
+
+        Lane& lane = lanes[laneKey];
+        QueuedTask queuedTask = std::move(lane.tasks.front());
+        lane.tasks.pop_front();
+        lane.running = true;
+        queued--;
+        if(queuedTask.priority == JetSetPriority::High)
+            lane.highPriorityTasks--;
+        else
+            queuedLowPriority--;
+        statistics.queued = queued;
+        slotAvailable.notify_one();
+
+        auto startTime = std::chrono::steady_clock::now();
+        auto delay = std::chrono::duration_cast<std::chrono::microseconds>(startTime - queuedTask.submitTime);
+        JetSetPriorityStatistics& priorityStatistics = (queuedTask.priority == JetSetPriority::High) ? statistics.highPriority : statistics.lowPriority;
+        priorityStatistics.executed++;
+        priorityStatistics.totalDelay += delay;
+        priorityStatistics.maxDelay = std::max(priorityStatistics.maxDelay, delay);
+
+        lock.unlock();
+        try {
+            queuedTask.task();
+        }
+        catch(const std::exception& e) {
+            std::string message = "Jet set request failed: " + std::string(e.what()) + "\n";
+            DAQLOG_E(jetModuleLogger, message.c_str());
+        }
+        catch(...) {
+            std::string message = "Jet set request failed with an unknown exception.\n";
+            DAQLOG_E(jetModuleLogger, message.c_str());
+        }
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queuedTask.submitTime);
+        lock.lock();
+
+        statistics.executed++;
+        statistics.totalLatency += latency;
+        statistics.maxLatency = std::max(statistics.maxLatency, latency);
+
+        // Next task of the lane may only start now, it goes to the back of the ready queue so that other lanes get their turn
+        Lane& finishedLane = lanes[laneKey];
+        finishedLane.running = false;
+        if(finishedLane.tasks.empty()) {
+            lanes.erase(laneKey);
+            statistics.lanes = lanes.size();
+            taskAvailable.notify_all();
+            if(lanes.empty())
+                idle.notify_all();
+        }
+        else {
+            scheduleLane(laneKey, finishedLane);
+        }
+    }
+}
+
+END_NAMESPACE_JET_MODULE
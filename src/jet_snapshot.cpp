@@ -0,0 +1,250 @@
+#include "jet_snapshot.h"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <json/reader.h>
+#include <json/writer.h>
+#include "jet_module_exceptions.h"
+
+#define JET_SNAPSHOT_FORMAT "JetModuleSnapshot"
+#define JET_SNAPSHOT_FORMAT_VERSION (1)
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Reads Jet states from a snapshot file.
+ * 
+ * @param fileName Path of the snapshot file.
+ * @param rootDeviceId Global ID of the root device. Snapshot of a different device is ignored.
+ * @param entries Filled with the Jet states stored in the snapshot.
+ * @return true if the snapshot has been read, false if it doesn't exist, is damaged or belongs to a different device.
+ */
+bool JetSnapshot::load(const std::string& fileName, const std::string& rootDeviceId, std::vector<JetSnapshotEntry>& entries)
+{
+    size_t records;
+    return load(fileName, rootDeviceId, entries, records);
+}
+
+/**
+ * @brief Reads Jet states from a snapshot file. Records are applied in file order, so the latest record of a path wins.
+ * 
+ * @param fileName Path of the snapshot file.
+ * @param rootDeviceId Global ID of the root device. Snapshot of a different device is ignored.
+ * @param entries Filled with the Jet states stored in the snapshot, ordered by path.
+ * @param records Number of records in the file, including outdated ones. Used to decide when the file is compacted.
+ * @return true if the snapshot has been read, false if it doesn't exist, is damaged or belongs to a different device.
+ */
+bool JetSnapshot::load(const std::string& fileName, const std::string& rootDeviceId, std::vector<JetSnapshotEntry>& entries, size_t& records)
+{
+    std::ifstream file(fileName);
+    if(!file.is_open())
+        return false;
+
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    auto parseLine = [&reader](const std::string& line, Json::Value& document) {
+        std::string errors;
+        return reader->parse(line.data(), line.data() + line.size(), &document, &errors);
+    };
+
+    std::string line;
+    Json::Value header;
+    if(!std::getline(file, line) || !parseLine(line, header) || header["Format"].asString() != JET_SNAPSHOT_FORMAT
+        || header["Version"].asInt() != JET_SNAPSHOT_FORMAT_VERSION || header["RootDevice"].asString() != rootDeviceId) {
+        std::string message = "Ignoring snapshot \"" + fileName + "\", it is not a snapshot of device \"" + rootDeviceId + "\".\n";
+        DAQLOG_W(jetModuleLogger, message.c_str());
+        return false;
+    }
+
+    std::map<std::string, JetSnapshotEntry> loaded;
+    size_t loadedRecords = 0;
+    bool torn = false;
+    while(std::getline(file, line)) {
+        if(line.empty())
+            continue;
+
+        // Only the last record can be torn by a crash while appending, anything before it means the file is damaged
+        Json::Value document;
+        JetSnapshotEntry entry;
+        bool removed = false;
+        bool parsed = !torn && parseLine(line, document);
+        if(parsed) {
+            removed = document["Removed"].asBool();
+            parsed = removed || kindFromString(document["Kind"].asString(), entry.kind);
+        }
+        if(!parsed) {
+            if(torn) {
+                std::string message = "Ignoring snapshot \"" + fileName + "\", it is damaged.\n";
+                DAQLOG_W(jetModuleLogger, message.c_str());
+                return false;
+            }
+            torn = true;
+            continue;
+        }
+
+        loadedRecords++;
+        entry.path = document["Path"].asString();
+        if(removed) {
+            loaded.erase(entry.path);
+            continue;
+        }
+        entry.lane = document["Lane"].asString();
+        entry.version = document["Version"].asUInt64();
+        entry.value = document["Value"];
+        loaded[entry.path] = std::move(entry);
+    }
+    if(torn) {
+        std::string message = "Ignoring the last record of snapshot \"" + fileName + "\", it has not been written completely.\n";
+        DAQLOG_W(jetModuleLogger, message.c_str());
+    }
+
+    std::vector<JetSnapshotEntry> result;
+    result.reserve(loaded.size());
+    for(auto& pathAndEntry : loaded)
+        result.push_back(std::move(pathAndEntry.second));
+    entries.swap(result);
+    records = loadedRecords;
+    return true;
+}
+
+/**
+ * @brief Writes Jet states to a snapshot file, replacing the previous snapshot together with its outdated records.
+ * 
+ * @param fileName Path of the snapshot file.
+ * @param rootDeviceId Global ID of the root device.
+ * @param entries Jet states to be stored. Versions are computed from their values.
+ * @return true if the snapshot has been written.
+ */
+bool JetSnapshot::write(const std::string& fileName, const std::string& rootDeviceId, const std::vector<JetSnapshotEntry>& entries)
+{
+    std::string temporaryFileName = fileName + ".tmp";
+    {
+        std::ofstream file(temporaryFileName, std::ios::trunc);
+        if(!file.is_open()) {
+            std::string message = "Could not write snapshot \"" + temporaryFileName + "\".\n";
+            DAQLOG_E(jetModuleLogger, message.c_str());
+            return false;
+        }
+
+        Json::Value header;
+        header["Format"] = JET_SNAPSHOT_FORMAT;
+        header["Version"] = JET_SNAPSHOT_FORMAT_VERSION;
+        header["RootDevice"] = rootDeviceId;
+        file << serialize(header) << '\n';
+
+        for(const auto& entry : entries)
+            file << serializeEntry(entry) << '\n';
+
+        if(!file.flush()) {
+            std::string message = "Could not write snapshot \"" + temporaryFileName + "\".\n";
+            DAQLOG_E(jetModuleLogger, message.c_str());
+            return false;
+        }
+    }
+
+    if(std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0) {
+        std::string message = "Could not replace snapshot \"" + fileName + "\".\n";
+        DAQLOG_E(jetModuleLogger, message.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Appends records of changed and removed Jet states to an existing snapshot file. Records of unchanged Jet states are not touched.
+ * 
+ * @param fileName Path of the snapshot file. It has to be written by write() beforehand.
+ * @param entries Jet states which have been added or changed. Versions are computed from their values.
+ * @param removedPaths Paths of the Jet states which have been removed.
+ * @return true if the records have been appended.
+ */
+bool JetSnapshot::append(const std::string& fileName, const std::vector<JetSnapshotEntry>& entries, const std::vector<std::string>& removedPaths)
+{
+    std::ofstream file(fileName, std::ios::app);
+    if(!file.is_open()) {
+        std::string message = "Could not append to snapshot \"" + fileName + "\".\n";
+        DAQLOG_E(jetModuleLogger, message.c_str());
+        return false;
+    }
+
+    // Records are written in a single block, so a crash can tear only the last of them
+    std::string records;
+    for(const auto& entry : entries)
+        records += serializeEntry(entry) + '\n';
+    for(const auto& path : removedPaths) {
+        Json::Value document;
+        document["Path"] = path;
+        document["Removed"] = true;
+        records += serialize(document) + '\n';
+    }
+    file << records;
+
+    if(!file.flush()) {
+        std::string message = "Could not append to snapshot \"" + fileName + "\".\n";
+        DAQLOG_E(jetModuleLogger, message.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Computes version stamp of a Jet state as FNV-1a hash of its compact serialized form.
+ * 
+ * @param value Value of the Jet state.
+ * @return Version stamp.
+ */
+uint64_t JetSnapshot::computeVersion(const Json::Value& value)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for(unsigned char c : serialize(value)) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string JetSnapshot::serialize(const Json::Value& value)
+{
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, value);
+}
+
+std::string JetSnapshot::serializeEntry(const JetSnapshotEntry& entry)
+{
+    Json::Value document;
+    document["Path"] = entry.path;
+    document["Kind"] = kindToString(entry.kind);
+    document["Lane"] = entry.lane;
+    document["Version"] = Json::UInt64(computeVersion(entry.value));
+    document["Value"] = entry.value;
+    return serialize(document);
+}
+
+const char* JetSnapshot::kindToString(JetSnapshotStateKind kind)
+{
+    switch(kind) {
+        case JetSnapshotStateKind::ObjectProperty:
+            return "ObjectProperty";
+        case JetSnapshotStateKind::Property:
+            return "Property";
+        default:
+            return "Component";
+    }
+}
+
+bool JetSnapshot::kindFromString(const std::string& str, JetSnapshotStateKind& kind)
+{
+    if(str == "Component")
+        kind = JetSnapshotStateKind::Component;
+    else if(str == "ObjectProperty")
+        kind = JetSnapshotStateKind::ObjectProperty;
+    else if(str == "Property")
+        kind = JetSnapshotStateKind::Property;
+    else
+        return false;
+    return true;
+}
+
+END_NAMESPACE_JET_MODULE
@@ -4,7 +4,9 @@
 
 BEGIN_NAMESPACE_JET_MODULE
 
-OpendaqEventHandler::OpendaqEventHandler() : jetPeerWrapper(JetPeerWrapper::getInstance())
+OpendaqEventHandler::OpendaqEventHandler(const JetServerConfig& config)
+    : config(config)
+    , jetPeerWrapper(JetPeerWrapper::getInstance())
 {
 
 }
@@ -27,26 +29,34 @@ void OpendaqEventHandler::updateProperty(const ComponentPtr& component, const Di
     PropertyPtr property = component.getProperty(fullPath);
     CoreType propertyType = property.getValueType();
 
+    // Event may have waited in the OpendaqEventQueue while a newer value was applied (e.g. a Jet write handled inline),
+    // so the current value of the property is published instead of the one carried by the event
+    DictPtr<IString, IBaseObject> currentParameters = Dict<IString, IBaseObject>();
+    currentParameters.set("Name", eventParameters.get("Name"));
+    currentParameters.set("Path", eventParameters.get("Path"));
+    if(propertyType != CoreType::ctProc && propertyType != CoreType::ctFunc)
+        currentParameters.set("Value", component.getPropertyValue(fullPath));
+
     std::string message = "Update of property with CoreType " + std::to_string(static_cast<int>(propertyType)) + " is not supported currently.\n";
 
     switch(propertyType) {
         case CoreType::ctBool:
-            updateSimpleProperty<bool>(component, eventParameters);
+            updateSimpleProperty<bool>(component, currentParameters);
             break;
         case CoreType::ctInt:
-            updateSimpleProperty<int64_t>(component, eventParameters);
+            updateSimpleProperty<int64_t>(component, currentParameters);
             break;
         case CoreType::ctFloat:
-            updateSimpleProperty<double>(component, eventParameters);
+            updateSimpleProperty<double>(component, currentParameters);
             break;
         case CoreType::ctString:
-            updateSimpleProperty<std::string>(component, eventParameters);
+            updateSimpleProperty<std::string>(component, currentParameters);
             break;
         case CoreType::ctList:
-            updateListProperty(component, eventParameters);
+            updateListProperty(component, currentParameters);
             break;
         case CoreType::ctDict:
-            updateDictProperty(component, eventParameters);
+            updateDictProperty(component, currentParameters);
             break;
         case CoreType::ctRatio:
             DAQLOG_W(jetModuleLogger, message.c_str());
@@ -72,6 +82,31 @@ void OpendaqEventHandler::updateProperty(const ComponentPtr& component, const Di
 
 }
 
+/**
+ * @brief Addresses to a batch of property value changes applied between beginUpdate and endUpdate of a component
+ * (CoreEventId::PropertyObjectUpdateEnd). All the changes are notified to Jet together.
+ * 
+ * @param component Component whose property values are changed.
+ * @param eventParameters Dictionary filled with data describing the change. "UpdatedProperties" holds names and new values of the properties.
+ */
+void OpendaqEventHandler::updateProperties(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters)
+{
+    DictPtr<IString, IBaseObject> updatedProperties = eventParameters.get("UpdatedProperties");
+    StringPtr propertyPath = String("");
+    if(eventParameters.hasKey("Path"))
+        propertyPath = eventParameters.get("Path");
+
+    // Changes of the Jet state are collected and notified once at the end of the scope
+    JetWriteScope writeScope;
+    for(const auto& updatedProperty : updatedProperties) {
+        DictPtr<IString, IBaseObject> propertyParameters = Dict<IString, IBaseObject>();
+        propertyParameters.set("Name", updatedProperty.first);
+        propertyParameters.set("Path", propertyPath);
+        propertyParameters.set("Value", updatedProperty.second);
+        updateProperty(component, propertyParameters);
+    }
+}
+
 /**
  * @brief Addresses to a simple property (BoolProperty, IntProperty, FloatProperty and StringProperty) value change initiated 
  * by openDAQ client/server.
@@ -88,26 +123,7 @@ void OpendaqEventHandler::updateSimpleProperty(const ComponentPtr& component, co
 
     DataType propertyValue = eventParameters.get("Value");
 
-    bool isNestedProperty = propertyPath.empty();
-    std::string componentId = component.getGlobalId();
-    std::vector<std::string> nestedPropertyNames; // These are the names of ObjectProperties under which the property that has been updated is nested
-
-    std::string jetStatePath;
-    if(isNestedProperty)
-        jetStatePath = componentId;
-    else {
-        nestedPropertyNames = extractNestedPropertyNames(propertyPath);
-        jetStatePath = componentId + "/" + nestedPropertyNames[0]; // ObjectProperty (CoreType::ctObject) is reperesnted as a separate Jet state
-    }
-    Json::Value jetState = jetPeerWrapper.readJetState(jetStatePath); // Jet state before the change
-
-    if(isNestedProperty)
-        jetState[propertyName] = propertyValue;
-    else {
-        setNestedPropertyValue<DataType>(jetState, nestedPropertyNames, propertyName, propertyValue);
-    }
-
-    jetPeerWrapper.updateJetState(jetStatePath, jetState);
+    updateJetStateValue(component, propertyPath, propertyName, propertyValue);
 }
 
 /**
@@ -124,27 +140,8 @@ void OpendaqEventHandler::updateListProperty(const ComponentPtr& component, cons
     ListPtr<IBaseObject> propertyValue = eventParameters.get("Value");
     CoreType listItemType = component.getProperty(propertyName).getItemType();
     Json::Value propertyValueJson = propertyConverter.convertOpendaqListToJsonArray(propertyValue, listItemType);
-    
-    bool isNestedProperty = propertyPath.empty();
-    std::string componentId = component.getGlobalId();
-    std::vector<std::string> nestedPropertyNames; // These are the names of ObjectProperties under which the property that has been updated is nested
-
-    std::string jetStatePath;
-    if(isNestedProperty)
-        jetStatePath = componentId;
-    else {
-        nestedPropertyNames = extractNestedPropertyNames(propertyPath);
-        jetStatePath = componentId + "/" + nestedPropertyNames[0]; // ObjectProperty (CoreType::ctObject) is reperesnted as a separate Jet state
-    }
-    Json::Value jetState = jetPeerWrapper.readJetState(jetStatePath); // Jet state before the change
-
-    if(isNestedProperty)
-        jetState[propertyName] = propertyValueJson;
-    else {
-        setNestedPropertyValue<Json::Value>(jetState, nestedPropertyNames, propertyName, propertyValueJson);
-    }
 
-    jetPeerWrapper.updateJetState(jetStatePath, jetState);
+    updateJetStateValue(component, propertyPath, propertyName, propertyValueJson);
 }
 
 /**
@@ -161,27 +158,8 @@ void OpendaqEventHandler::updateDictProperty(const ComponentPtr& component, cons
     DictPtr<IString, IBaseObject> propertyValue = eventParameters.get("Value");
     CoreType dictItemType = component.getProperty(propertyName).getItemType();
     Json::Value propertyValueJson = propertyConverter.convertOpendaqDictToJsonDict(propertyValue, dictItemType);
-    
-    bool isNestedProperty = propertyPath.empty();
-    std::string componentId = component.getGlobalId();
-    std::vector<std::string> nestedPropertyNames; // These are the names of ObjectProperties under which the property that has been updated is nested
-
-    std::string jetStatePath;
-    if(isNestedProperty)
-        jetStatePath = componentId;
-    else {
-        nestedPropertyNames = extractNestedPropertyNames(propertyPath);
-        jetStatePath = componentId + "/" + nestedPropertyNames[0]; // ObjectProperty (CoreType::ctObject) is reperesnted as a separate Jet state
-    }
-    Json::Value jetState = jetPeerWrapper.readJetState(jetStatePath); // Jet state before the change
 
-    if(isNestedProperty)
-        jetState[propertyName] = propertyValueJson;
-    else {
-        setNestedPropertyValue<Json::Value>(jetState, nestedPropertyNames, propertyName, propertyValueJson);
-    }
-
-    jetPeerWrapper.updateJetState(jetStatePath, jetState);
+    updateJetStateValue(component, propertyPath, propertyName, propertyValueJson);
 }
 
 /**
@@ -207,12 +185,10 @@ void OpendaqEventHandler::updateFunctionProperty(const ComponentPtr& component,
 void OpendaqEventHandler::updateActiveStatus(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters)
 {
     std::string path = component.getGlobalId();
-    Json::Value jetState = jetPeerWrapper.readJetState(path);
-
-    bool newActiveStatus = eventParameters.get("Active");
+    // Status is read from the component, the event may have been queued behind a newer change
+    bool newActiveStatus = component.getActive();
 
-    jetState["Active"] = newActiveStatus;
-    jetPeerWrapper.updateJetState(path, jetState);
+    jetPeerWrapper.updateJetStateValue(path, {"Active"}, newActiveStatus);
 }
 
 /**
@@ -224,7 +200,6 @@ void OpendaqEventHandler::updateActiveStatus(const ComponentPtr& component, cons
 void OpendaqEventHandler::addProperty(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters)
 {
     std::string path = component.getGlobalId();
-    Json::Value jetState = jetPeerWrapper.readJetState(path);
 
     // Property name in eventParameters is in "Property {<property_name>}" format, so we have to extract the string between curly braces
     std::string propertyName = extractPropertyName(eventParameters.get("Property"));
@@ -235,8 +210,43 @@ void OpendaqEventHandler::addProperty(const ComponentPtr& component, const DictP
     }
 
     PropertyPtr property = component.getProperty(propertyName);
-    propertyManager.determinePropertyType<ComponentPtr>(component, property, jetState);
-    jetPeerWrapper.updateJetState(path, jetState);
+    Json::Value propertyJson;
+    propertyManager.determinePropertyType<ComponentPtr>(component, property, propertyJson);
+
+    // Callable properties are published as Jet methods, so there might be nothing to add to the Jet state
+    for(const auto& key : propertyJson.getMemberNames())
+        jetPeerWrapper.updateJetStateValue(path, {key}, propertyJson[key]);
+}
+
+/**
+ * @brief Removes a property from the Jet states of a component. Member of the component's Jet state is removed, as well as the Jet state
+ * or method which was published for the property itself.
+ * 
+ * @param component Component from which the property has been removed.
+ * @param eventParameters Parameters of the core event. "Name" holds the name of the removed property.
+ */
+void OpendaqEventHandler::removeProperty(const ComponentPtr& component, const DictPtr<IString, IBaseObject>& eventParameters)
+{
+    std::string path = component.getGlobalId();
+    std::string propertyName = eventParameters.get("Name");
+    std::string propertyPath = eventParameters.get("Path");
+
+    // Only top-level properties are handled, nested ones belong to the Jet state of their ObjectProperty
+    if(!propertyPath.empty()) {
+        std::string message = "Nested property \"" + propertyName + "\" has been removed from component \"" + component.getName() + "\". Jet state is not updated.\n";
+        DAQLOG_W(jetModuleLogger, message.c_str());
+        return;
+    }
+
+    Json::Value jetState = jetPeerWrapper.getCachedJetState(path);
+    if(jetState.isObject() && jetState.isMember(propertyName)) {
+        jetState.removeMember(propertyName);
+        jetPeerWrapper.updateJetState(path, jetState);
+    }
+
+    // ObjectProperties, properties published with JetStateLayout::PerProperty and callable properties live at "<globalId>/<propertyName>".
+    // Only that path is removed, Jet states below it belong to child components, which may have the same local ID as the property.
+    jetPeerWrapper.removeJetStates(path + "/" + propertyName, false);
 }
 
 /**
@@ -284,26 +294,32 @@ std::vector<std::string> OpendaqEventHandler::extractNestedPropertyNames(const s
 }
 
 /**
- * @brief Sets the property value which is nested under ObjectProperty(ies) (CoreType::ctObject).
+ * @brief Sets a new property value in the Jet state which represents the property. Properties nested under ObjectProperty(ies)
+ * (CoreType::ctObject) are located in a separate Jet state of the top-most ObjectProperty. With JetStateLayout::PerProperty
+ * every other property has its own Jet state.
  * 
- * @tparam PropertyType Type of the property which corresponds to types from Json::ValueType.
- * @param jetState Jet state under which the property is located.
- * @param nestedPropertyNames Names of the ObjectProperty(ies) under which the property is nested.
- * @param propertyName Name of the Property.
- * @param propertyValue Value of the property.
+ * @param component Component which owns the property.
+ * @param propertyPath Path of the ObjectProperty(ies) under which the property is nested. Empty if the property is not nested.
+ * @param propertyName Name of the property.
+ * @param newValue New value of the property represented in Json.
  */
-template <typename PropertyType>
-void OpendaqEventHandler::setNestedPropertyValue(Json::Value& jetState, const std::vector<std::string>& nestedPropertyNames, const std::string& propertyName, const PropertyType& propertyValue)
+void OpendaqEventHandler::updateJetStateValue(const ComponentPtr& component, const std::string& propertyPath, const std::string& propertyName, const Json::Value& newValue)
 {
-    Json::Value* currentJsonVal = &jetState;
-    for(size_t i = 0; i < nestedPropertyNames.size(); ++i) {
-        if(i == nestedPropertyNames.size() - 1) { // Last element sets the value
-            (*currentJsonVal)[nestedPropertyNames[i]][propertyName] = propertyValue;
-        } 
-        else { // Intermediate elements navigate/create the structure
-            currentJsonVal = &((*currentJsonVal)[nestedPropertyNames[i]]);
-        }
+    std::string jetStatePath = component.getGlobalId();
+    std::vector<std::string> valuePath;
+
+    if(propertyPath.empty() && config.stateLayout == JetStateLayout::PerProperty) {
+        jetPeerWrapper.updateJetState(jetStatePath + "/" + propertyName, newValue);
+        return;
     }
+
+    if(!propertyPath.empty()) {
+        valuePath = extractNestedPropertyNames(propertyPath); // These are the names of ObjectProperties under which the property is nested
+        jetStatePath += "/" + valuePath[0]; // ObjectProperty (CoreType::ctObject) is represented as a separate Jet state
+    }
+    valuePath.push_back(propertyName);
+
+    jetPeerWrapper.updateJetStateValue(jetStatePath, valuePath, newValue);
 }
 
 END_NAMESPACE_JET_MODULE
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "opendaq_event_queue.h"
+#include <algorithm>
+#include <exception>
+#include <string>
+#include "jet_peer_wrapper.h"
+
+BEGIN_NAMESPACE_JET_MODULE
+
+/**
+ * @brief Constructs a new OpendaqEventQueue and starts its publisher thread.
+ * 
+ * @param asynchronous If false, no thread is started and every event is handled on the thread which raised it.
+ */
+OpendaqEventQueue::OpendaqEventQueue(bool asynchronous)
+    : asynchronous(asynchronous)
+    , running(asynchronous)
+    , busy(false)
+    , enqueued(0)
+{
+    if(asynchronous)
+        publisherThread = std::thread(&OpendaqEventQueue::runPublisher, this);
+}
+
+OpendaqEventQueue::~OpendaqEventQueue()
+{
+    stop();
+}
+
+/**
+ * @brief Hands an openDAQ event over to the publisher thread.
+ * Events raised while a value change requested from Jet is being applied are handled immediately. These are raised on a worker
+ * of the set executor rather than on a device thread, and their Jet state updates have to be merged by the active JetWriteScope.
+ * Such an event can overtake older events which are still queued. Handlers therefore publish the current values read from openDAQ
+ * rather than the values carried by the event, so the older event can't overwrite the newer value once it is processed.
+ * 
+ * @param task Function which updates the Jet states affected by the event.
+ */
+void OpendaqEventQueue::dispatch(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(running && !JetWriteScope::isActive()) {
+            tasks.push_back(std::move(task));
+            enqueued++;
+            statistics.queued = tasks.size();
+            statistics.peakQueued = std::max(statistics.peakQueued, tasks.size());
+            taskAvailable.notify_one();
+            return;
+        }
+        statistics.processedInline++;
+    }
+    execute(task);
+}
+
+/**
+ * @brief Waits until all queued events have been processed.
+ * 
+ * @param timeout Maximum time to wait.
+ * @return true if the queue is empty and the publisher thread is idle, false if the timeout expired first.
+ */
+bool OpendaqEventQueue::waitUntilIdle(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return idle.wait_for(lock, timeout, [this]() { return tasks.empty() && !busy; });
+}
+
+/**
+ * @brief Waits until the events queued before the call have been processed. Unlike waitUntilIdle, events queued in the meantime
+ * are not waited for, so the wait is bounded even if openDAQ raises events continuously.
+ * 
+ */
+void OpendaqEventQueue::waitForQueuedEvents()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = enqueued;
+    taskProcessed.wait(lock, [this, target]() { return statistics.processed >= target; });
+}
+
+/**
+ * @brief Stops the publisher thread after all queued events have been processed. Events dispatched afterwards are handled immediately.
+ * 
+ */
+void OpendaqEventQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    taskAvailable.notify_all();
+
+    if(publisherThread.joinable())
+        publisherThread.join();
+}
+
+/**
+ * @brief Returns a snapshot of the queue counters.
+ * 
+ * @return OpendaqEventQueueStatistics object.
+ */
+OpendaqEventQueueStatistics OpendaqEventQueue::getStatistics()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+void OpendaqEventQueue::runPublisher()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+        taskAvailable.wait(lock, [this]() { return !running || !tasks.empty(); });
+        if(tasks.empty())
+            return;
+
+        Task task = std::move(tasks.front());
+        tasks.pop_front();
+        statistics.queued = tasks.size();
+        busy = true;
+
+        lock.unlock();
+        execute(task);
+        lock.lock();
+
+        busy = false;
+        statistics.processed++;
+        taskProcessed.notify_all();
+        if(tasks.empty())
+            idle.notify_all();
+    }
+}
+
+void OpendaqEventQueue::execute(const Task& task)
+{
+    try {
+        task();
+    }
+    catch(const std::exception& e) {
+        std::string message = "Failed to update Jet state after openDAQ event: " + std::string(e.what()) + "\n";
+        DAQLOG_E(jetModuleLogger, message.c_str());
+    }
+    catch(...) {
+        std::string message = "Failed to update Jet state after openDAQ event with an unknown exception.\n";
+        DAQLOG_E(jetModuleLogger, message.c_str());
+    }
+}
+
+END_NAMESPACE_JET_MODULE
@@ -0,0 +1,147 @@
+#include "publish_filter.h"
+#include <opendaq/opendaq.h>
+
+BEGIN_NAMESPACE_JET_MODULE
+
+PublishFilter::PublishFilter(const JetPublishFilter& filter)
+    : filter(filter)
+{
+}
+
+/**
+ * @brief Checks whether a component (or folder) and its whole subtree are excluded from publishing.
+ * 
+ * @param component Checked component.
+ * @return true if the component matches any of the exclusion rules.
+ */
+bool PublishFilter::prunes(const ComponentPtr& component) const
+{
+    if(filter.excludeInvisible && !component.getVisible())
+        return true;
+    if(matchesAnyGlob(component.getGlobalId(), filter.excludePaths))
+        return true;
+    if(hasAnyTag(component, filter.excludeTags))
+        return true;
+
+    if(filter.excludeTypes.empty())
+        return false;
+    // Pure folders have no type, they can only be pruned by path, tags or visibility
+    JetComponentType type = getComponentType(component);
+    if(type == JetComponentType::Component && component.supportsInterface<IFolder>())
+        return false;
+    return filter.excludeTypes.count(type) > 0;
+}
+
+/**
+ * @brief Checks whether a component lies in a subtree which is excluded from publishing. Used for components added at runtime.
+ * 
+ * @param component Checked component.
+ * @return true if the component or any of its ancestors (except the root device) is pruned.
+ */
+bool PublishFilter::prunesAncestorOf(const ComponentPtr& component) const
+{
+    for(ComponentPtr current = component; current.assigned() && current.getParent().assigned(); current = current.getParent()) {
+        if(prunes(current))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether the Jet state of a component which hasn't been pruned is published.
+ * 
+ * @param component Checked component.
+ * @return true if the component matches all inclusion rules.
+ */
+bool PublishFilter::includes(const ComponentPtr& component) const
+{
+    if(!filter.includeTypes.empty() && filter.includeTypes.count(getComponentType(component)) == 0)
+        return false;
+    if(!filter.includePaths.empty() && !matchesAnyGlob(component.getGlobalId(), filter.includePaths))
+        return false;
+    if(!filter.includeTags.empty() && !hasAnyTag(component, filter.includeTags))
+        return false;
+    return true;
+}
+
+/**
+ * @brief Determines the type of a component. Channels are checked before function blocks, because every channel is a function block too.
+ * 
+ * @param component Component whose type is determined.
+ * @return JetComponentType of the component.
+ */
+JetComponentType PublishFilter::getComponentType(const ComponentPtr& component)
+{
+    if(component.supportsInterface<IDevice>())
+        return JetComponentType::Device;
+    if(component.supportsInterface<IChannel>())
+        return JetComponentType::Channel;
+    if(component.supportsInterface<IFunctionBlock>())
+        return JetComponentType::FunctionBlock;
+    if(component.supportsInterface<ISignal>())
+        return JetComponentType::Signal;
+    if(component.supportsInterface<IInputPort>())
+        return JetComponentType::InputPort;
+    return JetComponentType::Component;
+}
+
+/**
+ * @brief Matches a global ID against a glob. "*" matches any characters except "/", "**" matches any characters including "/"
+ * and "?" matches a single character except "/".
+ * 
+ * @param pattern Glob pattern.
+ * @param path Matched global ID.
+ * @return true if the whole path matches the pattern.
+ */
+bool PublishFilter::matchGlob(const std::string& pattern, const std::string& path)
+{
+    // matched[i] tells whether the pattern consumed so far matches the first i characters of the path. Every pattern element is
+    // applied to all prefixes at once, so the time is bounded by pattern length times path length regardless of the wildcards.
+    std::vector<bool> matched(path.size() + 1, false);
+    matched[0] = true;
+
+    for(size_t patternPos = 0; patternPos < pattern.size(); patternPos++) {
+        std::vector<bool> next(path.size() + 1, false);
+        char element = pattern[patternPos];
+
+        if(element == '*') {
+            bool crossesSeparator = (patternPos + 1 < pattern.size() && pattern[patternPos + 1] == '*');
+            if(crossesSeparator)
+                patternPos++;
+            // Wildcard matches an empty string or extends a match by one more character
+            for(size_t i = 0; i <= path.size(); i++)
+                next[i] = matched[i] || (i > 0 && next[i - 1] && (crossesSeparator || path[i - 1] != '/'));
+        }
+        else {
+            for(size_t i = 0; i < path.size(); i++)
+                next[i + 1] = matched[i] && (element == '?' ? path[i] != '/' : element == path[i]);
+        }
+
+        matched.swap(next);
+    }
+    return matched[path.size()];
+}
+
+bool PublishFilter::hasAnyTag(const ComponentPtr& component, const std::vector<std::string>& tags) const
+{
+    if(tags.empty())
+        return false;
+
+    TagsPtr componentTags = component.getTags();
+    for(const auto& tag : tags) {
+        if(componentTags.contains(String(tag)))
+            return true;
+    }
+    return false;
+}
+
+bool PublishFilter::matchesAnyGlob(const std::string& path, const std::vector<std::string>& patterns) const
+{
+    for(const auto& pattern : patterns) {
+        if(matchGlob(pattern, path))
+            return true;
+    }
+    return false;
+}
+
+END_NAMESPACE_JET_MODULE
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
 #include "jet_server_test.h"
 #include <coreobjects/argument_info_factory.h>
 #include <coreobjects/callable_info_factory.h>
@@ -324,4 +326,582 @@ TEST_F(JetServerTest, TestFunctionPropertyFunction)
     jsonArray.append(30);
     result = callingPeer.callMethod(path, jsonArray, timeout);
     ASSERT_EQ(result.asInt(), 20);
-}
\ No newline at end of file
+}
+
+// Ensures that several Jet states can be set in a single batch over the persistent peer
+TEST_F(JetServerTest, TestSetJetStatesBatch)
+{
+    ChannelPtr channel = rootDevice.getChannels()[0];
+    std::string channelPath = toStdString(channel.getGlobalId());
+    rootDevice.addProperty(IntProperty("TestBatchInt", 1));
+    rootDevice.addProperty(StringProperty("TestBatchString", "before"));
+    channel.addProperty(IntProperty("TestBatchChannelInt", 1));
+    ASSERT_TRUE(jetServer->waitForOpendaqEvents(std::chrono::seconds(JET_GET_VALUE_TIMEOUT)));
+
+    Json::Value jetState = jetPeerWrapper.readJetState(rootDevicePath);
+    jetState["TestBatchInt"] = 2;
+    jetState["TestBatchString"] = "after";
+    Json::Value channelJetState = jetPeerWrapper.readJetState(channelPath);
+    channelJetState["TestBatchChannelInt"] = 3;
+
+    std::future<Json::Value> responses = jetPeerWrapper.setJetStates({{rootDevicePath, jetState}, {channelPath, channelJetState}});
+    ASSERT_EQ(responses.wait_for(std::chrono::seconds(JET_STATE_SET_TIMEOUT)), std::future_status::ready);
+    Json::Value result = responses.get();
+    ASSERT_EQ(result.size(), 2u);
+    for(const auto& response : result)
+        EXPECT_FALSE(response.isMember(hbk::jsonrpc::ERR));
+
+    EXPECT_EQ(getPropertyValueInJetTimeout("TestBatchInt", 2).asInt(), 2);
+    int64_t intValue = rootDevice.getPropertyValue("TestBatchInt");
+    std::string stringValue = rootDevice.getPropertyValue("TestBatchString");
+    EXPECT_EQ(intValue, 2);
+    EXPECT_EQ(stringValue, "after");
+
+    // Values are applied by the set executor, so the channel may be updated after the root device
+    auto startTime = std::chrono::steady_clock::now();
+    int64_t channelValue = channel.getPropertyValue("TestBatchChannelInt");
+    while(channelValue != 3 && std::chrono::steady_clock::now() - startTime < std::chrono::seconds(JET_GET_VALUE_TIMEOUT)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        channelValue = channel.getPropertyValue("TestBatchChannelInt");
+    }
+    EXPECT_EQ(channelValue, 3);
+}
+
+
+// Ensures that value changes requested from Jet are applied by the set executor
+TEST_F(JetServerTest, TestSetExecutorStatistics)
+{
+    std::string propertyName = "TestExecutorInt";
+    rootDevice.addProperty(IntProperty(propertyName, 1));
+    JetSetExecutorStatistics statisticsBefore = jetPeerWrapper.getSetExecutorStatistics();
+
+    Json::Value jetState = jetPeerWrapper.readJetState(rootDevicePath);
+    jetState[propertyName] = 2;
+    std::future<Json::Value> response = jetPeerWrapper.setJetState(rootDevicePath, jetState);
+    ASSERT_EQ(response.wait_for(std::chrono::seconds(JET_STATE_SET_TIMEOUT)), std::future_status::ready);
+
+    EXPECT_EQ(getPropertyValueInJetTimeout(propertyName, 2).asInt(), 2);
+    JetSetExecutorStatistics statistics = jetPeerWrapper.getSetExecutorStatistics();
+    EXPECT_EQ(statistics.threads, JetServerConfig().setWorkerThreads + JetServerConfig().priorityWorkerThreads);
+    EXPECT_GT(statistics.executed, statisticsBefore.executed);
+    EXPECT_EQ(statistics.rejected, statisticsBefore.rejected);
+}
+
+
+// Ensures that Jet state paths are resolved to components and properties, also when they were not indexed while publishing
+TEST_F(JetServerTest, TestComponentIndexResolve)
+{
+    std::string propertyName = "TestIndexInt";
+    rootDevice.addProperty(IntProperty(propertyName, 1));
+    ComponentPtr channel = rootDevice.getChannels()[0];
+    std::string channelPath = toStdString(channel.getGlobalId());
+
+    ComponentIndex componentIndex(instance);
+    ComponentIndexEntry entry;
+
+    ASSERT_TRUE(componentIndex.resolve(channelPath, entry));
+    EXPECT_EQ(entry.component.getGlobalId(), channel.getGlobalId());
+    EXPECT_TRUE(entry.propertyName.empty());
+
+    ASSERT_TRUE(componentIndex.resolve(rootDevicePath + "/" + propertyName, entry));
+    EXPECT_EQ(entry.component.getGlobalId(), rootDevice.getGlobalId());
+    EXPECT_EQ(entry.propertyName, propertyName);
+    EXPECT_EQ(componentIndex.size(), 2u);
+
+    componentIndex.removeComponent(rootDevicePath);
+    EXPECT_EQ(componentIndex.size(), 0u);
+    EXPECT_FALSE(componentIndex.resolve(rootDevicePath + "/NonExistent", entry));
+}
+
+
+// Ensures that only members which differ from the published Jet state are applied
+TEST_F(JetServerTest, TestExtractChangedMembers)
+{
+    Json::Value current;
+    current["Unchanged"] = 1;
+    current["Changed"] = "before";
+    current["Nested"]["A"] = true;
+    current["Nested"]["B"] = 2.5;
+
+    Json::Value incoming = current;
+    incoming["Changed"] = "after";
+    incoming["Nested"]["B"] = 3.5;
+    incoming["Added"] = 7;
+
+    Json::Value changes = JetEventHandler::extractChangedMembers(incoming, current, false);
+    EXPECT_EQ(changes.getMemberNames(), std::vector<std::string>({"Added", "Changed", "Nested"}));
+    EXPECT_EQ(changes["Nested"], incoming["Nested"]);
+
+    changes = JetEventHandler::extractChangedMembers(incoming, current, true);
+    EXPECT_EQ(changes["Nested"].getMemberNames(), std::vector<std::string>({"B"}));
+
+    EXPECT_TRUE(JetEventHandler::extractChangedMembers(current, current, true).empty());
+    EXPECT_EQ(JetEventHandler::extractChangedMembers(incoming, Json::Value(), false), incoming);
+}
+
+
+// Ensures that a value which the cached Jet state still shows is applied, if openDAQ has changed it in the meantime
+TEST_F(JetServerTest, TestSetComparesWithCurrentValues)
+{
+    std::string propertyName = "TestStaleInt";
+    rootDevice.addProperty(IntProperty(propertyName, 1));
+    ASSERT_TRUE(jetServer->waitForOpendaqEvents(std::chrono::seconds(JET_GET_VALUE_TIMEOUT)));
+    Json::Value jetState = jetPeerWrapper.getCachedJetState(rootDevicePath);
+
+    // Event of this change may still be queued when the set request is compared with the Jet state
+    rootDevice.setPropertyValue(propertyName, 2);
+    std::future<Json::Value> response = jetPeerWrapper.setJetState(rootDevicePath, jetState);
+    ASSERT_EQ(response.wait_for(std::chrono::seconds(JET_STATE_SET_TIMEOUT)), std::future_status::ready);
+
+    auto startTime = std::chrono::steady_clock::now();
+    int64_t valueInOpendaq = rootDevice.getPropertyValue(propertyName);
+    while(valueInOpendaq != 1 && std::chrono::steady_clock::now() - startTime < std::chrono::seconds(JET_GET_VALUE_TIMEOUT)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        valueInOpendaq = rootDevice.getPropertyValue(propertyName);
+    }
+    EXPECT_EQ(valueInOpendaq, 1);
+}
+
+
+// Ensures that properties changed within a single openDAQ update reach Jet
+TEST_F(JetServerTest, TestBatchedPropertyUpdate)
+{
+    rootDevice.addProperty(IntProperty("TestBatchedInt", 1));
+    rootDevice.addProperty(StringProperty("TestBatchedString", "before"));
+
+    rootDevice.beginUpdate();
+    rootDevice.setPropertyValue("TestBatchedInt", 2);
+    rootDevice.setPropertyValue("TestBatchedString", "after");
+    rootDevice.endUpdate();
+
+    EXPECT_EQ(getPropertyValueInJetTimeout("TestBatchedInt", 2).asInt(), 2);
+    EXPECT_EQ(getPropertyValueInJetTimeout("TestBatchedString", "after").asString(), "after");
+}
+
+
+// Ensures that in delta mode changed members are notified in the "_delta" companion instead of the whole Jet state
+TEST_F(JetServerTest, TestDeltaNotifications)
+{
+    std::string propertyName = "TestDeltaInt";
+    std::string deltaPath = rootDevicePath + JET_DELTA_STATE_SUFFIX;
+    rootDevice.addProperty(IntProperty(propertyName, 1));
+    JetServerConfig config;
+    config.deltaNotifications = true;
+    restartJetServer(config);
+    ASSERT_EQ(jetPeerWrapper.readJetState(deltaPath)["Changed"], Json::Value(Json::objectValue));
+
+    rootDevice.setPropertyValue(propertyName, 2);
+    ASSERT_TRUE(jetServer->waitForOpendaqEvents(std::chrono::seconds(JET_GET_VALUE_TIMEOUT)));
+
+    Json::Value expectedDelta;
+    expectedDelta["Version"] = 1;
+    expectedDelta["Changed"][propertyName] = 2;
+    expectedDelta["Removed"] = Json::Value(Json::arrayValue);
+    EXPECT_EQ(readJetStateTimeout(deltaPath, expectedDelta), expectedDelta);
+    // Whole Jet state is only notified again once the delta document grows above the threshold
+    EXPECT_EQ(jetPeerWrapper.readJetState(rootDevicePath)[propertyName].asInt(), 1);
+    EXPECT_EQ(jetPeerWrapper.getCachedJetState(rootDevicePath)[propertyName].asInt(), 2);
+}
+
+
+// Ensures that with the per-property layout every property is a Jet state of its own, which is notified whole also in delta mode
+TEST_F(JetServerTest, TestPerPropertyLayout)
+{
+    std::string propertyName = "TestPerPropertyInt";
+    std::string propertyPath = rootDevicePath + "/" + propertyName;
+    rootDevice.addProperty(IntProperty(propertyName, 1));
+    JetServerConfig config;
+    config.stateLayout = JetStateLayout::PerProperty;
+    config.deltaNotifications = true;
+    restartJetServer(config);
+
+    EXPECT_EQ(jetPeerWrapper.readJetState(propertyPath).asInt(), 1);
+    EXPECT_FALSE(jetPeerWrapper.readJetState(rootDevicePath).isMember(propertyName));
+    std::vector<std::string> jetStatePaths = getJetStatePaths();
+    EXPECT_EQ(std::find(jetStatePaths.begin(), jetStatePaths.end(), propertyPath + JET_DELTA_STATE_SUFFIX), jetStatePaths.end());
+
+    rootDevice.setPropertyValue(propertyName, 2);
+    ASSERT_TRUE(jetServer->waitForOpendaqEvents(std::chrono::seconds(JET_GET_VALUE_TIMEOUT)));
+    EXPECT_EQ(readJetStateTimeout(propertyPath, 2).asInt(), 2);
+
+    std::future<Json::Value> response = jetPeerWrapper.setJetState(propertyPath, 3);
+    ASSERT_EQ(response.wait_for(std::chrono::seconds(JET_STATE_SET_TIMEOUT)), std::future_status::ready);
+    EXPECT_EQ(readJetStateTimeout(propertyPath, 3).asInt(), 3);
+    int64_t valueInOpendaq = rootDevice.getPropertyValue(propertyName);
+    EXPECT_EQ(valueInOpendaq, 3);
+}
+
+
+// Ensures that changes of a Jet state within the coalescing window are notified once, with the latest value
+TEST_F(JetServerTest, TestNotificationCoalescing)
+{
+    std::string propertyName = "TestCoalescedInt";
+    rootDevice.addProperty(IntProperty(propertyName, 1));
+    JetServerConfig config;
+    config.notificationCoalescingWindow = std::chrono::milliseconds(500);
+    restartJetServer(config);
+
+    rootDevice.setPropertyValue(propertyName, 2);
+    rootDevice.setPropertyValue(propertyName, 3);
+    ASSERT_TRUE(jetServer->waitForOpendaqEvents(std::chrono::seconds(JET_GET_VALUE_TIMEOUT)));
+    ASSERT_TRUE(jetPeerWrapper.waitForQueuedCommands(std::chrono::seconds(JET_GET_VALUE_TIMEOUT)));
+    EXPECT_EQ(jetPeerWrapper.readJetState(rootDevicePath)[propertyName].asInt(), 1);
+
+    EXPECT_EQ(getPropertyValueInJetTimeout(propertyName, 3).asInt(), 3);
+}
+
+
+// Ensures that changes made while a value requested from Jet is applied are notified once the write scope ends
+TEST_F(JetServerTest, TestWriteScopeMergesEchoes)
+{
+    std::string path = rootDevicePath + "/TestEchoState";
+    Json::Value jetState;
+    jetState["Value"] = 1;
+    jetPeerWrapper.publishJetState(path, jetState, nullptr);
+    ASSERT_TRUE(jetPeerWrapper.waitForPublications(std::chrono::seconds(JET_STATE_SET_TIMEOUT)));
+
+    {
+        JetWriteScope writeScope;
+        jetState["Value"] = 2;
+        jetPeerWrapper.updateJetState(path, jetState);
+        jetState["Value"] = 3;
+        jetPeerWrapper.updateJetState(path, jetState);
+        ASSERT_TRUE(jetPeerWrapper.waitForQueuedCommands(std::chrono::seconds(JET_GET_VALUE_TIMEOUT)));
+        EXPECT_EQ(jetPeerWrapper.readJetState(path)["Value"].asInt(), 1);
+    }
+
+    EXPECT_EQ(readJetStateTimeout(path, jetState)["Value"].asInt(), 3);
+}
+
+
+// Ensures that in synchronous mode a set request is answered with an error if the value cannot be applied
+TEST_F(JetServerTest, TestSynchronousSetReportsErrors)
+{
+    std::string propertyName = "TestReadOnlyInt";
+    rootDevice.addProperty(IntPropertyBuilder(propertyName, 1).setReadOnly(true).build());
+    JetServerConfig config;
+    config.synchronousSetTimeout = std::chrono::milliseconds(1000);
+    restartJetServer(config);
+
+    Json::Value jetState = jetPeerWrapper.readJetState(rootDevicePath);
+    jetState[propertyName] = 2;
+    std::future<Json::Value> response = jetPeerWrapper.setJetState(rootDevicePath, jetState);
+    ASSERT_EQ(response.wait_for(std::chrono::seconds(JET_STATE_SET_TIMEOUT)), std::future_status::ready);
+    EXPECT_TRUE(response.get().isMember(hbk::jsonrpc::ERR));
+
+    int64_t valueInOpendaq = rootDevice.getPropertyValue(propertyName);
+    EXPECT_EQ(valueInOpendaq, 1);
+}
+
+
+// Ensures that compiled property setters apply values and reject incompatible ones
+TEST_F(JetServerTest, TestCompiledPropertySetter)
+{
+    std::string propertyName = "TestSetterInt";
+    rootDevice.addProperty(IntProperty(propertyName, 1));
+    PropertyPtr property = rootDevice.getProperty(propertyName);
+
+    JetPropertySetter setter = JetEventHandler::compileSetter(property);
+    EXPECT_EQ(setter.valueType, CoreType::ctInt);
+
+    EXPECT_TRUE(jetEventHandler.applySetter(setter, rootDevice, propertyName, 5).empty());
+    int64_t valueInOpendaq = rootDevice.getPropertyValue(propertyName);
+    EXPECT_EQ(valueInOpendaq, 5);
+
+    EXPECT_FALSE(jetEventHandler.applySetter(setter, rootDevice, propertyName, "five").empty());
+    valueInOpendaq = rootDevice.getPropertyValue(propertyName);
+    EXPECT_EQ(valueInOpendaq, 5);
+
+    // Values are converted like before setters were compiled, so booleans still accept 0 and 1
+    std::string boolName = "TestSetterBool";
+    rootDevice.addProperty(BoolProperty(boolName, false));
+    JetPropertySetter boolSetter = JetEventHandler::compileSetter(rootDevice.getProperty(boolName));
+    EXPECT_TRUE(jetEventHandler.applySetter(boolSetter, rootDevice, boolName, 1).empty());
+    bool boolInOpendaq = rootDevice.getPropertyValue(boolName);
+    EXPECT_TRUE(boolInOpendaq);
+
+    // Read-only flag changed after compiling is respected
+    std::string lockName = "TestSetterLocked";
+    std::string lockedName = "TestSetterLockedInt";
+    rootDevice.addProperty(BoolProperty(lockName, false));
+    rootDevice.addProperty(IntPropertyBuilder(lockedName, 1).setReadOnly(EvalValue("$" + lockName)).build());
+    JetPropertySetter lockedSetter = JetEventHandler::compileSetter(rootDevice.getProperty(lockedName));
+    rootDevice.setPropertyValue(lockName, true);
+    EXPECT_FALSE(jetEventHandler.applySetter(lockedSetter, rootDevice, lockedName, 5).empty());
+    valueInOpendaq = rootDevice.getPropertyValue(lockedName);
+    EXPECT_EQ(valueInOpendaq, 1);
+}
+
+
+// Ensures that Jet method calls are executed in the high-priority lane of the set executor
+TEST_F(JetServerTest, TestMethodCallPriority)
+{
+    hbk::jet::Peer callingPeer(hbk::jet::JET_UNIX_DOMAIN_SOCKET_NAME, 0, "callingPeer");
+    double timeout = 50; // 50ms
+
+    std::string propName = "TestPriorityFunc";
+    rootDevice.addProperty(FunctionProperty(propName, FunctionInfo(CoreType::ctInt)));
+    rootDevice.setPropertyValue(propName, Function([] () { return 7; }));
+    JetSetExecutorStatistics statisticsBefore = jetPeerWrapper.getSetExecutorStatistics();
+
+    std::string path = rootDevicePath + "/" + propName;
+    Json::Value result = callingPeer.callMethod(path, Json::Value(), timeout);
+    ASSERT_EQ(result.asInt(), 7);
+
+    JetSetExecutorStatistics statistics = jetPeerWrapper.getSetExecutorStatistics();
+    EXPECT_EQ(statistics.highPriority.executed, statisticsBefore.highPriority.executed + 1);
+    EXPECT_EQ(statistics.lowPriority.executed, statisticsBefore.lowPriority.executed);
+    EXPECT_EQ(statistics.priorityThreads, JetServerConfig().priorityWorkerThreads);
+}
+
+
+// Ensures that openDAQ events are handled in order on the publisher thread, not on the thread which raised them
+TEST_F(JetServerTest, TestOpendaqEventQueue)
+{
+    OpendaqEventQueue opendaqEventQueue;
+    std::vector<int> order;
+    std::thread::id callerThread = std::this_thread::get_id();
+    bool handledOnCaller = false;
+
+    for(int i = 0; i < 10; i++) {
+        opendaqEventQueue.dispatch([&order, &handledOnCaller, callerThread, i]() {
+            handledOnCaller = handledOnCaller || (std::this_thread::get_id() == callerThread);
+            order.push_back(i);
+        });
+    }
+
+    ASSERT_TRUE(opendaqEventQueue.waitUntilIdle(std::chrono::seconds(1)));
+    EXPECT_FALSE(handledOnCaller);
+    ASSERT_EQ(order.size(), 10u);
+    for(int i = 0; i < 10; i++)
+        EXPECT_EQ(order[i], i);
+
+    OpendaqEventQueueStatistics statistics = opendaqEventQueue.getStatistics();
+    EXPECT_EQ(statistics.processed, 10u);
+    EXPECT_EQ(statistics.queued, 0u);
+}
+
+
+// Ensures that captured publications are only sent to jetd once the capture is released
+TEST_F(JetServerTest, TestPublicationCapture)
+{
+    std::string path = rootDevicePath + "/TestCapturedState";
+    Json::Value jetState;
+    jetState["Value"] = 1;
+
+    JetPublicationCapture capture;
+    jetPeerWrapper.publishJetState(path, jetState, nullptr);
+    capture.end();
+    EXPECT_EQ(capture.size(), 1u);
+    ASSERT_TRUE(jetPeerWrapper.readJetState(path).isNull());
+
+    capture.release();
+    EXPECT_EQ(capture.size(), 0u);
+    ASSERT_TRUE(jetPeerWrapper.waitForPublications(std::chrono::seconds(JET_STATE_SET_TIMEOUT)));
+    EXPECT_EQ(jetPeerWrapper.readJetState(path)["Value"].asInt(), 1);
+}
+
+
+// Ensures that a property removed in openDAQ is removed from the Jet state of its component
+TEST_F(JetServerTest, TestPropertyRemoved)
+{
+    std::string propertyName = "TestRemovedInt";
+    rootDevice.addProperty(IntProperty(propertyName, 1));
+    ASSERT_EQ(getPropertyValueInJetTimeout(propertyName, 1).asInt(), 1);
+
+    rootDevice.removeProperty(propertyName);
+    EXPECT_TRUE(getPropertyValueInJetTimeout(propertyName, Json::Value()).isNull());
+}
+
+
+// Ensures that Jet states of a function block added at runtime are published and removed together with the function block
+TEST_F(JetServerTest, TestFunctionBlockAddedAndRemoved)
+{
+    FunctionBlockPtr functionBlock = rootDevice.addFunctionBlock("ref_fb_module_statistics");
+    std::string functionBlockPath = toStdString(functionBlock.getGlobalId());
+    std::string signalPath = toStdString(functionBlock.getSignals()[0].getGlobalId());
+    ASSERT_TRUE(jetServer->waitForOpendaqEvents(std::chrono::seconds(JET_GET_VALUE_TIMEOUT)));
+    ASSERT_TRUE(jetPeerWrapper.waitForPublications(std::chrono::seconds(JET_STATE_SET_TIMEOUT)));
+
+    std::vector<std::string> jetStatePaths = getJetStatePaths();
+    EXPECT_NE(std::find(jetStatePaths.begin(), jetStatePaths.end(), functionBlockPath), jetStatePaths.end());
+    EXPECT_NE(std::find(jetStatePaths.begin(), jetStatePaths.end(), signalPath), jetStatePaths.end());
+
+    rootDevice.removeFunctionBlock(functionBlock);
+    ASSERT_TRUE(jetServer->waitForOpendaqEvents(std::chrono::seconds(JET_GET_VALUE_TIMEOUT)));
+
+    jetStatePaths = getJetStatePaths();
+    EXPECT_EQ(std::find(jetStatePaths.begin(), jetStatePaths.end(), functionBlockPath), jetStatePaths.end());
+    EXPECT_EQ(std::find(jetStatePaths.begin(), jetStatePaths.end(), signalPath), jetStatePaths.end());
+    EXPECT_NE(std::find(jetStatePaths.begin(), jetStatePaths.end(), rootDevicePath), jetStatePaths.end());
+}
+
+
+// Ensures that in lazy publication mode devices publish an index, Jet states are composed on demand and evicted when idle
+TEST_F(JetServerTest, TestLazyPublication)
+{
+    hbk::jet::Peer callingPeer(hbk::jet::JET_UNIX_DOMAIN_SOCKET_NAME, 0, "callingPeer");
+    double timeout = 1000; // 1s, composing a Jet state takes longer than a regular method call
+    std::string channelPath = toStdString(rootDevice.getChannels()[0].getGlobalId());
+
+    JetServerConfig config;
+    config.lazyPublication = true;
+    config.lazyEvictionTimeout = std::chrono::milliseconds(200);
+    restartJetServer(config);
+
+    Json::Value index = jetPeerWrapper.readJetState(rootDevicePath + JET_INDEX_STATE_SUFFIX);
+    bool channelListed = false;
+    for(const auto& path : index["Components"])
+        channelListed = channelListed || (path.asString() == channelPath);
+    EXPECT_TRUE(channelListed);
+    std::vector<std::string> jetStatePaths = getJetStatePaths();
+    EXPECT_EQ(std::find(jetStatePaths.begin(), jetStatePaths.end(), channelPath), jetStatePaths.end());
+
+    Json::Value result = callingPeer.callMethod(rootDevicePath + JET_EXPAND_METHOD_SUFFIX, channelPath, timeout);
+    ASSERT_TRUE(result.isObject());
+    EXPECT_TRUE(result.isMember("Active"));
+    ASSERT_TRUE(jetPeerWrapper.waitForPublications(std::chrono::seconds(JET_STATE_SET_TIMEOUT)));
+    EXPECT_EQ(jetPeerWrapper.readJetState(channelPath)["Active"], result["Active"]);
+
+    result = callingPeer.callMethod(rootDevicePath + JET_EXPAND_METHOD_SUFFIX, rootDevicePath + "/NoSuchComponent", timeout);
+    EXPECT_TRUE(result.isString());
+
+    // Expanded Jet state is removed once it hasn't been expanded for the eviction timeout
+    bool evicted = false;
+    auto startTime = std::chrono::steady_clock::now();
+    while(!evicted && std::chrono::steady_clock::now() - startTime < std::chrono::seconds(2)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        jetStatePaths = getJetStatePaths();
+        evicted = std::find(jetStatePaths.begin(), jetStatePaths.end(), channelPath) == jetStatePaths.end();
+    }
+    EXPECT_TRUE(evicted);
+}
+
+
+// Ensures that global ID globs of publishing filters match path segments as documented
+TEST_F(JetServerTest, TestPublishFilterGlob)
+{
+    EXPECT_TRUE(PublishFilter::matchGlob("/RefDev0/IO/*/*", "/RefDev0/IO/AI/RefCh0"));
+    EXPECT_FALSE(PublishFilter::matchGlob("/RefDev0/*", "/RefDev0/IO/AI/RefCh0"));
+    EXPECT_TRUE(PublishFilter::matchGlob("/RefDev0/**", "/RefDev0/IO/AI/RefCh0"));
+    EXPECT_TRUE(PublishFilter::matchGlob("**/Sig/*", "/RefDev0/IO/AI/RefCh0/Sig/AI0"));
+    EXPECT_TRUE(PublishFilter::matchGlob("/RefDev0/IO/AI/RefCh?", "/RefDev0/IO/AI/RefCh1"));
+    EXPECT_FALSE(PublishFilter::matchGlob("/RefDev0/IO/AI/RefCh?", "/RefDev0/IO/AI/RefCh10"));
+    // Many wildcards against a long path which doesn't match must not take exponential time
+    EXPECT_FALSE(PublishFilter::matchGlob(std::string(40, '*') + "b", std::string(5000, 'a')));
+
+    // Excluded signals are pruned, while the channel owning them is still published
+    JetPublishFilter filterSpec;
+    filterSpec.excludeTypes = {JetComponentType::Signal};
+    PublishFilter filter(filterSpec);
+    ChannelPtr channel = rootDevice.getChannels()[0];
+    EXPECT_FALSE(filter.prunes(channel));
+    EXPECT_TRUE(filter.prunes(channel.getSignals()[0]));
+    EXPECT_TRUE(filter.includes(channel));
+}
+
+
+// Ensures that Jet states written to a snapshot are read back only for the same root device
+TEST_F(JetServerTest, TestSnapshotRoundTrip)
+{
+    std::string fileName = "jet_module_test_snapshot.jsonl";
+
+    JetSnapshotEntry entry;
+    entry.path = rootDevicePath;
+    entry.kind = JetSnapshotStateKind::Component;
+    entry.lane = rootDevicePath;
+    entry.value = jetPeerWrapper.getCachedJetState(rootDevicePath);
+    ASSERT_TRUE(JetSnapshot::write(fileName, rootDevicePath, {entry}));
+
+    std::vector<JetSnapshotEntry> entries;
+    ASSERT_TRUE(JetSnapshot::load(fileName, rootDevicePath, entries));
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].path, rootDevicePath);
+    EXPECT_EQ(entries[0].value, entry.value);
+    EXPECT_EQ(entries[0].version, JetSnapshot::computeVersion(entry.value));
+
+    EXPECT_FALSE(JetSnapshot::load(fileName, "/OtherDevice", entries));
+    std::remove(fileName.c_str());
+}
+
+
+// Ensures that records appended to a snapshot replace or remove the earlier records of their Jet states
+TEST_F(JetServerTest, TestSnapshotAppend)
+{
+    std::string fileName = "jet_module_test_append.jsonl";
+
+    JetSnapshotEntry changedEntry;
+    changedEntry.path = rootDevicePath + "/Changed";
+    changedEntry.lane = rootDevicePath;
+    changedEntry.value["Value"] = 1;
+    JetSnapshotEntry removedEntry = changedEntry;
+    removedEntry.path = rootDevicePath + "/Removed";
+    ASSERT_TRUE(JetSnapshot::write(fileName, rootDevicePath, {changedEntry, removedEntry}));
+
+    changedEntry.value["Value"] = 2;
+    ASSERT_TRUE(JetSnapshot::append(fileName, {changedEntry}, {removedEntry.path}));
+
+    std::vector<JetSnapshotEntry> entries;
+    size_t records = 0;
+    ASSERT_TRUE(JetSnapshot::load(fileName, rootDevicePath, entries, records));
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].path, changedEntry.path);
+    EXPECT_EQ(entries[0].value["Value"].asInt(), 2);
+    EXPECT_EQ(records, 4u);
+
+    // Record torn by a crash while appending is ignored, the records before it are kept
+    {
+        std::ofstream file(fileName, std::ios::app);
+        file << "{\"Path\":\"" << changedEntry.path << "\",\"Ki";
+    }
+    ASSERT_TRUE(JetSnapshot::load(fileName, rootDevicePath, entries, records));
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].value["Value"].asInt(), 2);
+    std::remove(fileName.c_str());
+}
+
+
+// Ensures that Jet states published from a snapshot are corrected once the openDAQ tree has been composed
+TEST_F(JetServerTest, TestSnapshotReconciliation)
+{
+    std::string fileName = "jet_module_test_reconcile.jsonl";
+    std::string removedPath = rootDevicePath + "/NoSuchComponent";
+
+    JetSnapshotEntry changedEntry;
+    changedEntry.path = rootDevicePath;
+    changedEntry.kind = JetSnapshotStateKind::Component;
+    changedEntry.lane = rootDevicePath;
+    changedEntry.value = jetPeerWrapper.getCachedJetState(rootDevicePath);
+    changedEntry.value["SnapshotOnlyProperty"] = 1;
+    JetSnapshotEntry removedEntry;
+    removedEntry.path = removedPath;
+    removedEntry.kind = JetSnapshotStateKind::Component;
+    removedEntry.lane = removedPath;
+    removedEntry.value["Value"] = 1;
+    ASSERT_TRUE(JetSnapshot::write(fileName, rootDevicePath, {changedEntry, removedEntry}));
+
+    JetServerConfig config;
+    config.snapshotFile = fileName;
+    restartJetServer(config);
+
+    // Reconciliation runs in the background
+    bool reconciled = false;
+    auto startTime = std::chrono::steady_clock::now();
+    while(!reconciled && std::chrono::steady_clock::now() - startTime < std::chrono::seconds(2)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::vector<std::string> jetStatePaths = getJetStatePaths();
+        reconciled = !jetPeerWrapper.readJetState(rootDevicePath).isMember("SnapshotOnlyProperty") &&
+                     std::find(jetStatePaths.begin(), jetStatePaths.end(), removedPath) == jetStatePaths.end();
+    }
+    EXPECT_TRUE(reconciled);
+    std::vector<std::string> jetStatePaths = getJetStatePaths();
+    EXPECT_NE(std::find(jetStatePaths.begin(), jetStatePaths.end(), rootDevicePath), jetStatePaths.end());
+
+    // Snapshot is updated from the reconciled Jet states, at the latest when JetServer is destroyed
+    restartJetServer(JetServerConfig());
+    std::vector<JetSnapshotEntry> entries;
+    ASSERT_TRUE(JetSnapshot::load(fileName, rootDevicePath, entries));
+    for(const auto& entry : entries)
+        EXPECT_NE(entry.path, removedPath);
+    std::remove(fileName.c_str());
+}
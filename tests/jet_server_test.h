@@ -58,13 +58,16 @@ protected:
     }
 
     virtual void TearDown() {
+        // Removes the Jet states published by the test, so that the next test publishes the same paths from scratch
         delete jetServer;
     }
 
     Json::Value getPropertyValueInJet(const std::string& propertyName);
     Json::Value getPropertyValueInJetTimeout(const std::string& propertyName, const Json::Value& expectedValue);
+    Json::Value readJetStateTimeout(const std::string& path, const Json::Value& expectedValue);
     void setPropertyValueInJet(const std::string& propertyName, const Json::Value& newValue);
     void setPropertyListInJet(const std::string& propertyName, const std::vector<std::string>& newValue);
+    void restartJetServer(const JetServerConfig& config);
 
     std::vector<std::string> getComponentIDs();
     std::vector<std::string> getJetStatePaths();
@@ -79,6 +82,8 @@ protected:
  */
 Json::Value JetServerTest::getPropertyValueInJet(const std::string& propertyName)
 {
+    // Changes made in openDAQ are published by the publisher thread of the JetServer
+    jetServer->waitForOpendaqEvents(std::chrono::seconds(JET_GET_VALUE_TIMEOUT));
     Json::Value jetState = jetPeerWrapper.readJetState(rootDevice.getGlobalId());
     Json::Value valueInJet = jetState.get(propertyName, Json::Value()); // default value is empty Json
     return valueInJet;
@@ -109,6 +114,30 @@ Json::Value JetServerTest::getPropertyValueInJetTimeout(const std::string& prope
     return valueInJet;
 }
 
+/**
+ * @brief Reads a Jet state from jetd repeatedly until it equals the expected value or the timeout expires. Needed for Jet states
+ * whose notifications are sent asynchronously.
+ * 
+ * @param path Path of the Jet state.
+ * @param expectedValue Value expected to be read from the Jet state.
+ * @return Json::Value object which contains the last value read from the Jet state.
+ */
+Json::Value JetServerTest::readJetStateTimeout(const std::string& path, const Json::Value& expectedValue)
+{
+    Json::Value jetState;
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto timeout = std::chrono::seconds(JET_GET_VALUE_TIMEOUT);
+    do {
+        jetState = jetPeerWrapper.readJetState(path);
+        if(jetState == expectedValue)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    } while(std::chrono::steady_clock::now() - startTime < timeout);
+
+    return jetState;
+}
+
 /**
  * @brief Sets a property value in a Jet state.
  * 
@@ -120,6 +149,19 @@ void JetServerTest::setPropertyValueInJet(const std::string& propertyName, const
     jetEventHandler.updateProperty(rootDevice, propertyName, newValue);
 }
 
+/**
+ * @brief Replaces the JetServer of the fixture with one using a different configuration. Jet states of the previous JetServer
+ * are removed by its destructor.
+ * 
+ * @param config Configuration of the new JetServer.
+ */
+void JetServerTest::restartJetServer(const JetServerConfig& config)
+{
+    delete jetServer;
+    jetServer = new JetServer(instance, config);
+    jetServer->publishJetStates();
+}
+
 /**
  * @brief Sets a list property value in a Jet state.
  * 